@@ -0,0 +1,111 @@
+// Compares the numeric codec used by the reader, writer and type guessing against the
+// standard library paths it replaced: pugixml/printf formatting on write and std::stod
+// with an exception per non-numeric string on read.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "detail/number_codec.hpp"
+
+namespace {
+
+template<typename F>
+double time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const std::string &name, double baseline_ms, double codec_ms, std::size_t count)
+{
+    std::cout << name << ": std " << baseline_ms << " ms, codec " << codec_ms << " ms ("
+        << count / (codec_ms * 1000) << " M/s, " << baseline_ms / codec_ms << "x)" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    const std::size_t Count = 1000000;
+
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+    std::vector<double> numbers;
+
+    for(std::size_t i = 0; i < Count; i++)
+    {
+        numbers.push_back(i % 4 == 0 ? (double)(long long)distribution(random) : distribution(random));
+    }
+
+    std::size_t checksum = 0;
+    char buffer[64];
+
+    auto printf_ms = time_ms([&]() {
+        for(auto number : numbers)
+        {
+            checksum += (std::size_t)std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+        }
+    });
+
+    auto format_ms = time_ms([&]() {
+        for(auto number : numbers)
+        {
+            checksum += xlnt::detail::format_number(number, buffer);
+        }
+    });
+
+    report("format", printf_ms, format_ms, Count);
+
+    // a text-heavy column: one string in three is not a number
+    std::vector<std::string> strings;
+
+    for(std::size_t i = 0; i < Count; i++)
+    {
+        strings.push_back(i % 3 == 0 ? "label " + std::to_string(i) : xlnt::detail::format_number(numbers[i]));
+    }
+
+    double sum = 0;
+
+    auto stod_ms = time_ms([&]() {
+        for(auto &string : strings)
+        {
+            try
+            {
+                sum += std::stod(string);
+            }
+            catch(const std::invalid_argument &)
+            {
+                checksum++;
+            }
+        }
+    });
+
+    auto parse_ms = time_ms([&]() {
+        for(auto &string : strings)
+        {
+            double number = 0;
+
+            if(xlnt::detail::parse_number(string, number))
+            {
+                sum += number;
+            }
+            else
+            {
+                checksum++;
+            }
+        }
+    });
+
+    report("parse", stod_ms, parse_ms, Count);
+
+    std::cout << "(checksum " << checksum << " " << sum << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Measures the allocations made while the cells of a large sheet are stored, adding them one at
+// a time with worksheet::get_cell as the loader used to and reading the sheet with
+// reader::read_worksheet with and without a dimension element. Every cell and row takes a fixed
+// number of allocations, so the rest are the bucket arrays of tables that were rehashed. The
+// times of read_worksheet include parsing the markup.
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/value.hpp>
+#include <xlnt/common/memory_resource.hpp>
+#include <xlnt/reader/reader.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+namespace {
+
+const std::size_t RowCount = 5000;
+const std::size_t ColumnCount = 40;
+
+// counts what the workbook's cell storage allocates
+class counting_resource : public xlnt::memory_resource
+{
+public:
+    counting_resource() : allocations(0), bytes(0)
+    {
+    }
+
+    std::size_t allocations;
+    std::size_t bytes;
+
+protected:
+    void *do_allocate(std::size_t size, std::size_t alignment) override
+    {
+        allocations++;
+        bytes += size;
+        return xlnt::default_resource()->allocate(size, alignment);
+    }
+
+    void do_deallocate(void *pointer, std::size_t size, std::size_t alignment) override
+    {
+        xlnt::default_resource()->deallocate(pointer, size, alignment);
+    }
+};
+
+template<typename F>
+double time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// each cell is one hash node and each row a hash node and a block holding the row and its count
+void report(const std::string &name, const counting_resource &counter, double ms)
+{
+    auto fixed = RowCount * ColumnCount + RowCount * 2;
+
+    std::cout << name << ": " << ms << " ms, " << counter.allocations << " allocations ("
+        << counter.allocations - fixed << " bucket arrays), " << counter.bytes / 1024 << " KB allocated" << std::endl;
+}
+
+// about 6 MB of numbers so that the sheet is read on one thread
+std::string make_sheet(bool with_dimension)
+{
+    std::string sheet = "<worksheet>";
+
+    if(with_dimension)
+    {
+        sheet += "<dimension ref=\"A1:" + xlnt::cell_reference::column_string_from_index(ColumnCount) + std::to_string(RowCount) + "\"/>";
+    }
+
+    sheet += "<sheetData>";
+
+    for(std::size_t i = 1; i <= RowCount; i++)
+    {
+        auto row = std::to_string(i);
+        sheet += "<row r=\"" + row + "\" spans=\"1:" + std::to_string(ColumnCount) + "\">";
+
+        for(std::size_t j = 1; j <= ColumnCount; j++)
+        {
+            sheet += "<c r=\"" + xlnt::cell_reference::column_string_from_index(j) + row + "\"><v>" + std::to_string(i * j) + "</v></c>";
+        }
+
+        sheet += "</row>";
+    }
+
+    return sheet + "</sheetData></worksheet>";
+}
+
+} // namespace
+
+int main()
+{
+    std::size_t checksum = 0;
+
+    {
+        counting_resource counter;
+        xlnt::workbook wb(&counter);
+        auto ws = wb.get_active_sheet();
+
+        auto ms = time_ms([&]() {
+            for(std::size_t i = 0; i < RowCount; i++)
+            {
+                for(std::size_t j = 0; j < ColumnCount; j++)
+                {
+                    ws.get_cell(xlnt::cell_reference(static_cast<column_t>(j), static_cast<row_t>(i))).set_value(static_cast<int>((i + 1) * (j + 1)));
+                }
+            }
+        });
+
+        report("get_cell one at a time", counter, ms);
+        checksum += ws.get_cell("B2").get_value().to_string().size();
+    }
+
+    for(auto with_dimension : { false, true })
+    {
+        auto sheet = make_sheet(with_dimension);
+        counting_resource counter;
+        xlnt::workbook wb(&counter);
+
+        auto ms = time_ms([&]() {
+            xlnt::reader::read_worksheet(wb.get_active_sheet(), sheet, {}, {});
+        });
+
+        report(with_dimension ? "read_worksheet with dimension" : "read_worksheet without dimension", counter, ms);
+        checksum += wb.get_active_sheet().get_cell("B2").get_value().to_string().size();
+    }
+
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
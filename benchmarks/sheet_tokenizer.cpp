@@ -0,0 +1,156 @@
+// Measures the sheetData tokenizer on its own and reader::read_worksheet with and without it.
+// The generic pugixml path is timed on the same sheet with a comment at the start of sheetData,
+// which the tokenizer leaves to the generic parser. Reading one column or the first thousand
+// rows is timed against reading the whole sheet.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/value.hpp>
+#include <xlnt/reader/reader.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/workbook/workbook.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "detail/sheet_tokenizer.hpp"
+
+namespace {
+
+template<typename F>
+double time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const std::string &name, std::size_t bytes, double ms)
+{
+    std::cout << name << ": " << ms << " ms (" << bytes / (ms * 1000) << " MB/s)" << std::endl;
+}
+
+// rows of a shared string, a styled number, a formula and an inline string, about 6 MB in all
+// so that the sheet is read on one thread
+std::string make_rows(std::size_t row_count)
+{
+    std::string rows;
+
+    for(std::size_t i = 1; i <= row_count; i++)
+    {
+        auto row = std::to_string(i);
+
+        rows += "<row r=\"" + row + "\" spans=\"1:4\">";
+        rows += "<c r=\"A" + row + "\" t=\"s\"><v>" + std::to_string(i % 100) + "</v></c>";
+        rows += "<c r=\"B" + row + "\" s=\"1\"><v>" + std::to_string(i * 0.25) + "</v></c>";
+        rows += "<c r=\"C" + row + "\"><f>B" + row + "*2</f><v>" + std::to_string(i * 0.5) + "</v></c>";
+        rows += "<c r=\"D" + row + "\" t=\"inlineStr\"><is><t>item &amp; " + row + "</t></is></c>";
+        rows += "</row>";
+    }
+
+    return rows;
+}
+
+} // namespace
+
+int main()
+{
+    const int Repetitions = 5;
+
+    auto rows = make_rows(30000);
+    auto sheet = "<worksheet><sheetData>" + rows + "</sheetData></worksheet>";
+    auto generic_sheet = "<worksheet><sheetData><!-- -->" + rows + "</sheetData></worksheet>";
+
+    std::vector<std::string> string_table;
+
+    for(int i = 0; i < 100; i++)
+    {
+        string_table.push_back("string " + std::to_string(i));
+    }
+
+    std::vector<std::size_t> style_ids = { 0, 0 };
+    std::size_t checksum = 0;
+
+    auto scan_ms = time_ms([&]() {
+        for(int i = 0; i < Repetitions; i++)
+        {
+            xlnt::detail::structural_scanner scanner(rows.data(), rows.data() + rows.size());
+
+            for(auto position = scanner.find(rows.data()); position != rows.data() + rows.size(); position = scanner.find(position + 1))
+            {
+                checksum++;
+            }
+        }
+    });
+
+    report("structural scan", rows.size() * Repetitions, scan_ms);
+
+    auto tokenize_ms = time_ms([&]() {
+        for(int i = 0; i < Repetitions; i++)
+        {
+            xlnt::detail::sheet_tokenizer tokenizer(rows.data(), rows.data() + rows.size());
+            auto token = tokenizer.next();
+
+            while(token == xlnt::detail::sheet_tokenizer::token::row || token == xlnt::detail::sheet_tokenizer::token::cell)
+            {
+                if(token == xlnt::detail::sheet_tokenizer::token::cell && !tokenizer.read_cell_content())
+                {
+                    break;
+                }
+
+                checksum++;
+                token = tokenizer.next();
+            }
+        }
+    });
+
+    report("tokenize", rows.size() * Repetitions, tokenize_ms);
+
+    auto read = [&](const std::string &xml) {
+        return time_ms([&]() {
+            for(int i = 0; i < Repetitions; i++)
+            {
+                xlnt::workbook wb;
+                xlnt::reader::read_worksheet(wb.get_active_sheet(), xml, string_table, style_ids);
+                checksum += wb.get_active_sheet().get_cell("A1").get_value().to_string().size();
+            }
+        });
+    };
+
+    auto generic_ms = read(generic_sheet);
+    auto tokenizer_ms = read(sheet);
+
+    report("read_worksheet, pugixml", sheet.size() * Repetitions, generic_ms);
+    report("read_worksheet, tokenizer", sheet.size() * Repetitions, tokenizer_ms);
+    std::cout << "speedup " << generic_ms / tokenizer_ms << "x" << std::endl;
+
+    auto read_projected = [&](const xlnt::load_options &options) {
+        return time_ms([&]() {
+            for(int i = 0; i < Repetitions; i++)
+            {
+                xlnt::workbook wb;
+                xlnt::reader::read_worksheet(wb.get_active_sheet(), sheet, string_table, style_ids, options);
+                checksum += wb.get_active_sheet().get_cell("B1").get_value().to_string().size();
+            }
+        });
+    };
+
+    xlnt::load_options one_column;
+    one_column.set_columns({ 1 });
+    auto column_ms = read_projected(one_column);
+
+    xlnt::load_options first_rows;
+    first_rows.set_rows(0, 999);
+    auto rows_ms = read_projected(first_rows);
+
+    report("read_worksheet, column B", sheet.size() * Repetitions, column_ms);
+    report("read_worksheet, rows 1-1000", sheet.size() * Repetitions, rows_ms);
+
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Compares parsing package parts with xml_document::load, as the reader used to, against
+// detail::parse_part, which parses the inflated buffer in place with per-part options.
+// Time is measured over several repetitions and memory as the most that pugixml held at once,
+// counted through its allocation hooks.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <pugixml.hpp>
+
+#include "detail/xml_part.hpp"
+
+namespace {
+
+std::size_t current_bytes = 0;
+std::size_t peak_bytes = 0;
+
+// each block is prefixed with its size so that deallocate can subtract it
+void *counting_allocate(std::size_t size)
+{
+    auto block = static_cast<std::size_t *>(std::malloc(size + sizeof(std::max_align_t)));
+
+    if(block == nullptr)
+    {
+        return nullptr;
+    }
+
+    *block = size;
+    current_bytes += size;
+    peak_bytes = std::max(peak_bytes, current_bytes);
+
+    return reinterpret_cast<char *>(block) + sizeof(std::max_align_t);
+}
+
+void counting_deallocate(void *pointer)
+{
+    if(pointer == nullptr)
+    {
+        return;
+    }
+
+    auto block = reinterpret_cast<std::size_t *>(static_cast<char *>(pointer) - sizeof(std::max_align_t));
+    current_bytes -= *block;
+    std::free(block);
+}
+
+template<typename F>
+double time_ms(F f)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string make_worksheet(std::size_t row_count)
+{
+    std::string xml = "<worksheet><dimension ref=\"A1:C" + std::to_string(row_count) + "\"/><sheetData>";
+
+    for(std::size_t i = 1; i <= row_count; i++)
+    {
+        auto row = std::to_string(i);
+
+        xml += "<row r=\"" + row + "\" spans=\"1:3\">";
+        xml += "<c r=\"A" + row + "\" t=\"s\"><v>" + std::to_string(i % 100) + "</v></c>";
+        xml += "<c r=\"B" + row + "\" s=\"1\"><v>" + std::to_string(i * 0.25) + "</v></c>";
+        xml += "<c r=\"C" + row + "\"><f>B" + row + "*2</f><v>" + std::to_string(i * 0.5) + "</v></c>";
+        xml += "</row>";
+    }
+
+    return xml + "</sheetData></worksheet>";
+}
+
+std::string make_shared_strings(std::size_t string_count)
+{
+    std::string xml = "<sst count=\"" + std::to_string(string_count) + "\" uniqueCount=\"" + std::to_string(string_count) + "\">";
+
+    for(std::size_t i = 0; i < string_count; i++)
+    {
+        xml += "<si><t>shared string &amp; " + std::to_string(i) + "</t></si>";
+    }
+
+    return xml + "</sst>";
+}
+
+void compare(const std::string &name, const std::string &xml, xlnt::detail::xml_part_kind kind)
+{
+    const int Repetitions = 5;
+
+    std::size_t load_peak = 0;
+    std::size_t inplace_peak = 0;
+
+    auto load_ms = time_ms([&]() {
+        for(int i = 0; i < Repetitions; i++)
+        {
+            auto baseline = peak_bytes = current_bytes;
+            pugi::xml_document document;
+            document.load(xml.c_str());
+            load_peak = peak_bytes - baseline;
+        }
+    });
+
+    auto inplace_ms = time_ms([&]() {
+        for(int i = 0; i < Repetitions; i++)
+        {
+            // the buffer is copied because it is overwritten, as an inflated part would be
+            auto buffer = xml;
+            auto baseline = peak_bytes = current_bytes;
+            pugi::xml_document document;
+            xlnt::detail::parse_part(document, buffer, kind);
+            inplace_peak = peak_bytes - baseline;
+        }
+    });
+
+    std::cout << name << " (" << xml.size() / 1024 << " KB)" << std::endl;
+    std::cout << "    load:       " << load_ms / Repetitions << " ms, " << load_peak / 1024 << " KB held by pugixml" << std::endl;
+    std::cout << "    parse_part: " << inplace_ms / Repetitions << " ms, " << inplace_peak / 1024 << " KB held by pugixml" << std::endl;
+}
+
+} // namespace
+
+int main()
+{
+    pugi::set_memory_management_functions(counting_allocate, counting_deallocate);
+
+    compare("worksheet", make_worksheet(50000), xlnt::detail::xml_part_kind::worksheet);
+    compare("shared strings", make_shared_strings(50000), xlnt::detail::xml_part_kind::shared_strings);
+
+    return 0;
+}
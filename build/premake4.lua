@@ -18,6 +18,7 @@ project "xlnt.test"
     }
     files { 
        "../tests/*.hpp",
+       "../tests/helpers/*.cpp",
        "../tests/runner-autogen.cpp"
     }
     links { "xlnt" }
@@ -26,6 +27,29 @@ project "xlnt.test"
     configuration "windows"
         defines { "WIN32" }
 	links { "Shlwapi" }
+    configuration "linux"
+        links { "pthread" }
+
+for _, benchmark in ipairs({ "number_codec", "sheet_load", "sheet_tokenizer", "xml_parse" }) do
+project ("xlnt.benchmark." .. benchmark)
+    kind "ConsoleApp"
+    language "C++"
+    targetname ("xlnt.benchmark." .. benchmark)
+    targetdir "../bin"
+    includedirs {
+       "../include",
+       "../source"
+    }
+    files {
+       "../benchmarks/" .. benchmark .. ".cpp"
+    }
+    links { "xlnt" }
+    flags { "Unicode" }
+    configuration "windows"
+        defines { "WIN32" }
+    configuration "linux"
+        links { "pthread" }
+end
 
 project "xlnt"
     kind "StaticLib"
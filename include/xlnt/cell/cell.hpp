@@ -45,6 +45,8 @@ struct timedelta;
 
 namespace detail {    
 struct cell_impl;
+struct string_classification;
+class style_registry;
 } // namespace detail
 
 /// <summary>
@@ -87,6 +89,8 @@ public:
     style &get_style();
     const style &get_style() const;
     void set_style(const style &s);
+    std::size_t get_style_id() const;
+    void set_style_id(std::size_t style_id);
 
     std::pair<int, int> get_anchor() const;
 
@@ -139,7 +143,11 @@ public:
     
 private:
     friend class worksheet;
+    friend class sparse_range;
     cell(detail::cell_impl *d);
+    void set_classified_value(const std::string &s, const detail::string_classification &classification);
+    void set_number_format_code(number_format::format format_code);
+    detail::style_registry &get_style_registry() const;
     detail::cell_impl *d_;
 };
 
@@ -4,6 +4,10 @@
 
 namespace xlnt {
 
+namespace detail {
+struct memory_counter;
+} // namespace detail
+
 class comment
 {
 public:
@@ -15,6 +19,8 @@ public:
     std::string get_author() const;
 
 private:
+    friend struct detail::memory_counter;
+
     std::string text_;
     std::string author_;
 };
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <string>
 
+#include <xlnt/common/types.hpp>
+
 namespace xlnt {
 
 struct date;
@@ -10,6 +12,10 @@ struct datetime;
 struct time;
 struct timedelta;
 
+namespace detail {
+struct memory_counter;
+} // namespace detail
+
 class value
 {
 public:
@@ -26,7 +32,7 @@ public:
     static value error(const std::string &error_string);
 
     value();
-    value(value &&v);
+    value(value &&v) XLNT_NOEXCEPT;
     value(const value &v);
     value(bool b);
     value(int8_t i);
@@ -101,6 +107,8 @@ public:
     friend void swap(value &left, value &right);
 
 private:
+    friend struct detail::memory_counter;
+
     type type_;
     std::string string_value_;
     long double numeric_value_;
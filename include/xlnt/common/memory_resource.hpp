@@ -0,0 +1,93 @@
+// Copyright (c) 2014 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace xlnt {
+
+/// <summary>
+/// A source of memory for the row maps and cell tables of a workbook's sheets, modelled on
+/// std::pmr::memory_resource so that a C++17 resource can be adapted by overriding the three do_
+/// functions to forward to it. The text a cell holds (string values, formulae and comments) is
+/// stored in the cell but its characters are still allocated from the global heap.
+/// </summary>
+class memory_resource
+{
+public:
+    virtual ~memory_resource();
+
+    void *allocate(std::size_t bytes, std::size_t alignment);
+    void deallocate(void *pointer, std::size_t bytes, std::size_t alignment);
+    bool is_equal(const memory_resource &other) const;
+
+protected:
+    virtual void *do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource &other) const;
+};
+
+/// <summary>
+/// The resource workbooks use unless they are given another, which allocates with operator new.
+/// </summary>
+memory_resource *default_resource();
+
+/// <summary>
+/// Hands out memory from blocks taken from upstream, each larger than the last, and gives
+/// nothing back until it is released or destroyed, when every block is freed at once. Like
+/// std::pmr::monotonic_buffer_resource it isn't synchronised, so each thread needs its own.
+/// </summary>
+class monotonic_resource : public memory_resource
+{
+public:
+    explicit monotonic_resource(std::size_t initial_block_size = 4096, memory_resource *upstream = default_resource());
+    ~monotonic_resource();
+
+    /// <summary>
+    /// Frees every block. Anything still using memory from this resource is left dangling.
+    /// </summary>
+    void release();
+
+    /// <summary>
+    /// The total size of the blocks taken from upstream.
+    /// </summary>
+    std::size_t get_reserved_size() const;
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+
+private:
+    monotonic_resource(const monotonic_resource &);
+    monotonic_resource &operator=(const monotonic_resource &);
+
+    memory_resource *upstream_;
+    std::size_t next_block_size_;
+    std::vector<std::pair<void *, std::size_t>> blocks_;
+    char *current_;
+    std::size_t remaining_;
+};
+
+} // namespace xlnt
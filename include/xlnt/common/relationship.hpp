@@ -129,7 +129,13 @@ public:
     }
     
     relationship();
-    relationship(const std::string &t, const std::string &r_id = "", const std::string &target_uri = "") : relationship(type_from_string(t), r_id, target_uri) {}
+    relationship(const std::string &t, const std::string &r_id = "", const std::string &target_uri = "") : relationship(type_from_string(t), r_id, target_uri)
+    {
+        if(type_ == type::invalid)
+        {
+            type_string_ = t;
+        }
+    }
     relationship(type t, const std::string &r_id = "", const std::string &target_uri = "");
     
     /// <summary>
@@ -153,11 +159,16 @@ public:
     std::string get_target_uri() const { return target_uri_; }
     
     type get_type() const { return type_; }
-    std::string get_type_string() const { return type_to_string(type_); }
+    
+    /// <summary>
+    /// gets the type as it appears in a relationships part. Types that have no enumerator are kept as they were read.
+    /// </summary>
+    std::string get_type_string() const { return type_string_.empty() ? type_to_string(type_) : type_string_; }
 
     friend bool operator==(const relationship &left, const relationship &right)
     {
         return left.type_ == right.type_
+            && left.type_string_ == right.type_string_
             && left.id_ == right.id_
             && left.source_uri_ == right.source_uri_
             && left.target_uri_ == right.target_uri_
@@ -166,6 +177,7 @@ public:
     
 private:
     type type_;
+    std::string type_string_;
     std::string id_;
     std::string source_uri_;
     std::string target_uri_;
@@ -24,5 +24,12 @@
 
 #include <cstdint>
 
+// MSVC 12 doesn't support noexcept, without which standard containers copy elements they could move
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define XLNT_NOEXCEPT
+#else
+#define XLNT_NOEXCEPT noexcept
+#endif
+
 typedef uint32_t row_t;
 typedef uint32_t column_t;
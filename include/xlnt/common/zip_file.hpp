@@ -5,14 +5,23 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-struct mz_zip_archive_tag;
-
 namespace xlnt {
 
+namespace detail {
+struct memory_counter;
+} // namespace detail
+
+/// <summary>
+/// A member of a zip_file. Sizes and offsets are 64-bit so that members and archives
+/// larger than 4 GB can be described; they are stored in ZIP64 extra fields when saved.
+/// </summary>
 struct zip_info
 {
+    zip_info();
+
     std::string filename;
     struct
     {
@@ -29,13 +38,84 @@ struct zip_info
     uint16_t create_version;
     uint16_t extract_version;
     uint16_t flag_bits;
+    uint16_t compress_type;
     std::size_t volume;
     uint32_t internal_attr;
     uint32_t external_attr;
-    std::size_t header_offset;
+    uint64_t header_offset;
     uint32_t crc;
-    std::size_t compress_size;
-    std::size_t file_size;
+    uint64_t compress_size;
+    uint64_t file_size;
+};
+
+class zip_file;
+
+/// <summary>
+/// A stream buffer over one member of a zip_file which inflates the member as it is read,
+/// so that no more than the 32 KB deflate window of it is held in memory at a time.
+/// The archive must outlive the buffer.
+/// </summary>
+class zip_streambuf : public std::streambuf
+{
+public:
+    zip_streambuf(zip_file &archive, const std::string &name);
+    ~zip_streambuf();
+
+private:
+    int_type underflow() override;
+
+    struct inflate_state;
+    std::unique_ptr<inflate_state> state_;
+};
+
+/// <summary>
+/// An input stream reading a member of a zip_file through a zip_streambuf.
+/// </summary>
+class zip_istream : public std::istream
+{
+public:
+    zip_istream(zip_file &archive, const std::string &name);
+
+private:
+    zip_streambuf buffer_;
+};
+
+/// <summary>
+/// A stream buffer which deflates everything written to it into a new member of a zip_file,
+/// so that a member of any size can be added while holding only its compressed bytes.
+/// The member is added when the buffer is closed or destroyed and no other member may be
+/// written to the archive before then.
+/// </summary>
+class zip_ostreambuf : public std::streambuf
+{
+public:
+    zip_ostreambuf(zip_file &archive, const std::string &name, int level);
+    ~zip_ostreambuf();
+
+    void close();
+
+private:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+    void deflate_input(bool finish);
+
+    struct deflate_state;
+    std::unique_ptr<deflate_state> state_;
+};
+
+/// <summary>
+/// An output stream writing a member of a zip_file through a zip_ostreambuf.
+/// </summary>
+class zip_ostream : public std::ostream
+{
+public:
+    zip_ostream(zip_file &archive, const std::string &name, int level = 9);
+
+    void close();
+
+private:
+    zip_ostreambuf buffer_;
 };
 
 class zip_file
@@ -95,22 +175,39 @@ public:
     
     void writestr(const std::string &arcname, const std::string &bytes);
     void writestr(const zip_info &arcname, const std::string &bytes);
+
+    // copies member arcname of source into this archive as it is stored there, without inflating it
+    void write_from(zip_file &source, const std::string &arcname);
+
+    // adds a member from an already deflated stream along with the size and crc32 of the uncompressed bytes
+    void write_deflated(const std::string &arcname, const std::string &deflated, std::uint64_t file_size, std::uint32_t crc);
     
     std::string get_filename() const { return filename_; }
     
     std::string comment;
     
 private:
-    void start_read();
-    void start_write();
-    
-    void append_comment();
-    void remove_comment();
+    friend class zip_streambuf;
+    friend class zip_ostreambuf;
+    friend struct detail::memory_counter;
+
+    void read_central_directory();
+    void write_central_directory(std::vector<char> &bytes) const;
+
+    const zip_info &find(const std::string &name) const;
+    std::size_t get_data_offset(const zip_info &info) const;
 
-    zip_info getinfo(int index);
+    void drop_loaded_directory();
+    void add_entry(zip_info info, const char *data, std::uint64_t size);
+    void end_entry(const zip_info &info);
 
-    std::unique_ptr<mz_zip_archive_tag> archive_;
+    // the local headers and data of every member followed, until a member is added after
+    // loading, by the central directory read from the source
     std::vector<char> buffer_;
+    std::size_t entries_end_;
+    std::string loaded_comment_;
+    std::vector<zip_info> entries_;
+    std::unordered_map<std::string, std::size_t> index_;
     std::stringstream open_stream_;
     std::string filename_;
 };
@@ -30,7 +30,9 @@
 
 namespace xlnt {
     
+class cell;
 class document_properties;
+class load_options;
 class relationship;
 class style;
 class workbook;
@@ -45,12 +47,21 @@ public:
     static void fast_parse(worksheet ws, std::istream &xml_source, const std::vector<std::string> &shared_string, const std::vector<style> &style_table, std::size_t color_index);
     static std::vector<relationship> read_relationships(zip_file &content, const std::string &filename);
     static std::vector<std::pair<std::string, std::string>> read_content_types(zip_file &archive);
+    // the Default and Override entries of [Content_Types].xml as extension or part name and type
+    static void read_content_types(zip_file &archive, std::vector<std::pair<std::string, std::string>> &default_types, std::vector<std::pair<std::string, std::string>> &override_types);
     static std::string determine_document_type(const std::vector<std::pair<std::string, std::string>> &override_types);
     static worksheet read_worksheet(std::istream &handle, workbook &wb, const std::string &title, const std::vector<std::string> &string_table);
-    static void read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids);
-    static std::vector<std::string> read_shared_string(const std::string &xml_string);
-    static std::string read_dimension(const std::string &xml_string);
-    static document_properties read_properties_core(const std::string &xml_string);
+    static void read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids);
+    // leaves cells holding shared strings empty and adds them to shared_string_cells with their
+    // index into the string table, so that the table can be read at the same time
+    static void read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::size_t> &style_ids, std::vector<std::pair<cell, std::size_t>> &shared_string_cells);
+    // read only the rows and columns options selects
+    static void read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const load_options &options);
+    static void read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::size_t> &style_ids, std::vector<std::pair<cell, std::size_t>> &shared_string_cells, const load_options &options);
+    static std::vector<style> read_styles(std::string xml_string);
+    static std::vector<std::string> read_shared_string(std::string xml_string);
+    static std::string read_dimension(std::string xml_string);
+    static document_properties read_properties_core(std::string xml_string);
     static std::vector<std::pair<std::string,std::string>> read_sheets(zip_file &archive);
     static workbook load_workbook(const std::string &filename, bool guess_types = false, bool data_only = false);
     static std::vector<std::pair<std::string, std::string>> detect_worksheets(zip_file &archive);
@@ -48,6 +48,16 @@ struct alignment
         justify
     };
     
+    bool operator==(const alignment &other) const
+    {
+        return horizontal == other.horizontal
+            && vertical == other.vertical
+            && text_rotation == other.text_rotation
+            && wrap_text == other.wrap_text
+            && shrink_to_fit == other.shrink_to_fit
+            && indent == other.indent;
+    }
+    
     horizontal_alignment horizontal = horizontal_alignment::general;
     vertical_alignment vertical = vertical_alignment::bottom;
     int text_rotation = 0;
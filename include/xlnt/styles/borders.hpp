@@ -23,10 +23,13 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include "color.hpp"
+
 namespace xlnt {
 
 class borders
 {
+public:
     struct border
     {
         enum class style
@@ -47,6 +50,11 @@ class borders
             thin
         };
         
+        bool operator==(const border &other) const
+        {
+            return style_ == other.style_ && color_ == other.color_;
+        }
+        
         style style_ = style::none;
         color color_ = color::black;
     };
@@ -59,6 +67,15 @@ class borders
         both
     };
     
+    bool operator==(const borders &other) const
+    {
+        return left == other.left
+            && right == other.right
+            && top == other.top
+            && bottom == other.bottom
+            && diagonal == other.diagonal;
+    }
+    
     border left;
     border right;
     border top;
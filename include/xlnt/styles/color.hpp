@@ -23,10 +23,20 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <string>
+
 namespace xlnt {
 
 struct color
 {
+    enum class type
+    {
+        indexed,
+        theme,
+        rgb,
+        auto_
+    };
+    
     static const color black;
     static const color white;
     static const color red;
@@ -38,12 +48,31 @@ struct color
     static const color yellow;
     static const color darkyellow;
     
-    color(int index)
+    color(int index) : type_(type::indexed), index(index)
+    {
+    }
+    
+    color(type t, int index) : type_(t), index(index)
+    {
+    }
+    
+    color(const std::string &rgb) : type_(type::rgb), index(0), rgb(rgb)
+    {
+    }
+    
+    bool operator==(const color &other) const
+    {
+        return type_ == other.type_ && index == other.index && rgb == other.rgb;
+    }
+    
+    bool operator!=(const color &other) const
     {
-        this->index = index;
+        return !(*this == other);
     }
     
+    type type_;
     int index;
+    std::string rgb;
 };
 
 } // namespace xlnt
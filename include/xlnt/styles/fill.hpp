@@ -55,6 +55,14 @@ public:
         pattern_mediumgray,
     };
     
+    bool operator==(const fill &other) const
+    {
+        return type_ == other.type_
+            && rotation == other.rotation
+            && start_color == other.start_color
+            && end_color == other.end_color;
+    }
+    
     type type_ = type::none;
     int rotation = 0;
     color start_color = color::white;
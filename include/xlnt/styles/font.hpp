@@ -23,10 +23,15 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <string>
+
+#include "color.hpp"
+
 namespace xlnt {
 
 class font
 {
+public:
     enum class underline
     {
         none,
@@ -36,15 +41,32 @@ class font
         single_accounting
     };
     
-    /*    std::string name = "Calibri";
-     int size = 11;
-     bool bold = false;
-     bool italic = false;
-     bool superscript = false;
-     bool subscript = false;
-     underline underline = underline::none;
-     bool strikethrough = false;
-     color color = color::black;*/
+    bool operator==(const font &other) const
+    {
+        return name == other.name
+            && size == other.size
+            && family == other.family
+            && scheme == other.scheme
+            && bold == other.bold
+            && italic == other.italic
+            && superscript == other.superscript
+            && subscript == other.subscript
+            && underline_ == other.underline_
+            && strikethrough == other.strikethrough
+            && color_ == other.color_;
+    }
+    
+    std::string name = "Calibri";
+    double size = 11;
+    int family = 2;
+    std::string scheme = "minor";
+    bool bold = false;
+    bool italic = false;
+    bool superscript = false;
+    bool subscript = false;
+    underline underline_ = underline::none;
+    bool strikethrough = false;
+    color color_ = color(color::type::theme, 1);
 };
 
 } // namespace xlnt
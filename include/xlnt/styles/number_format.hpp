@@ -93,8 +93,18 @@ public:
     number_format(format code) : format_code_(code) {}
     
     format get_format_code() const { return format_code_; }
-    void set_format_code(format format_code) { format_code_ = format_code; }
+    void set_format_code(format format_code) { format_code_ = format_code; custom_format_code_.clear(); }
     void set_format_code(const std::string &format_code) { custom_format_code_ = format_code; }
+    const std::string &get_custom_format_code() const { return custom_format_code_; }
+    
+    /// <summary>
+    /// The format code as written to styles.xml: the custom code if there is one, otherwise the
+    /// code of the enumerated format.
+    /// </summary>
+    std::string get_format_string() const;
+    
+    std::size_t hash() const;
+    bool operator==(const number_format &other) const;
     
 private:
     std::string custom_format_code_ = "";
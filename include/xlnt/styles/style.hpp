@@ -23,6 +23,8 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
+
 #include "font.hpp"
 #include "fill.hpp"
 #include "borders.hpp"
@@ -33,11 +35,16 @@
 
 namespace xlnt {
 
+namespace detail {
+struct memory_counter;
+} // namespace detail
+
 class style
 {
 public:
     style(bool static_ = false) : static_(static_) {}
     style(const style &rhs);
+    style &operator=(const style &rhs);
     
     style copy() const;
     
@@ -60,7 +67,13 @@ public:
     protection get_protection() const;
     void set_protection(protection protection);
     
+    std::size_t hash() const;
+    bool operator==(const style &other) const;
+    bool operator!=(const style &other) const { return !(*this == other); }
+    
 private:
+    friend struct detail::memory_counter;
+
     bool static_ = false;
     font font_;
     fill fill_;
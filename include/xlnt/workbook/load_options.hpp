@@ -0,0 +1,82 @@
+// Copyright (c) 2014 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../common/types.hpp"
+
+namespace xlnt {
+
+/// <summary>
+/// Selects the part of a file that workbook::load reads. By default everything is read.
+/// Sheets that aren't selected aren't inflated or parsed and are left out of the workbook,
+/// and rows and cells outside the selection are skipped in the markup without being decoded.
+/// A sheet loaded with some of its rows or columns holds only those when it is saved.
+/// </summary>
+class load_options
+{
+public:
+    load_options();
+
+    /// <summary>
+    /// Reads only the sheets with the given titles, keeping their order in the file.
+    /// Titles the file doesn't have are ignored and an empty list selects every sheet.
+    /// </summary>
+    void set_sheets(const std::vector<std::string> &titles);
+    const std::vector<std::string> &get_sheets() const;
+    bool includes_sheet(const std::string &title) const;
+
+    /// <summary>
+    /// Reads only the cells in the given columns, numbered from 0 as in cell_reference.
+    /// An empty list selects every column.
+    /// </summary>
+    void set_columns(const std::vector<column_t> &columns);
+    const std::vector<column_t> &get_columns() const;
+    bool includes_column(column_t column) const;
+
+    /// <summary>
+    /// Reads only the rows from first to last inclusive, numbered from 0 as in cell_reference.
+    /// </summary>
+    void set_rows(row_t first, row_t last);
+    void clear_rows();
+    bool has_rows() const;
+    row_t get_first_row() const;
+    row_t get_last_row() const;
+    bool includes_row(row_t row) const;
+
+    /// <summary>
+    /// True if only some of the rows or columns of a sheet are read.
+    /// </summary>
+    bool is_projected() const;
+
+private:
+    std::vector<std::string> sheets_;
+    std::vector<column_t> columns_;
+    bool has_rows_;
+    row_t first_row_;
+    row_t last_row_;
+};
+
+} // namespace xlnt
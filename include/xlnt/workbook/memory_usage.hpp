@@ -0,0 +1,73 @@
+// Copyright (c) 2014 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xlnt {
+
+/// <summary>
+/// The bytes a worksheet or workbook holds in memory, by category. The figures come from the
+/// sizes and capacities of the containers involved and the allocations they are known to make,
+/// so allocator bookkeeping is left out and each allocation may be off by a few bytes.
+/// </summary>
+struct memory_usage
+{
+    memory_usage();
+
+    // cell records and the rows holding them
+    std::size_t cells;
+    // text held by cell values and by the shared string table
+    std::size_t strings;
+    std::size_t formulas;
+    // the style table and the style ids read from the source
+    std::size_t styles;
+    // hyperlinks and relationships
+    std::size_t relationships;
+    std::size_t comments;
+    // buckets, keys and per-node pointers of the hash tables holding rows, cells and lookups
+    std::size_t hash_tables;
+    // everything else, such as merged ranges, row and column properties and the source archive
+    std::size_t other;
+
+    std::size_t total() const;
+
+    memory_usage &operator+=(const memory_usage &rhs);
+};
+
+/// <summary>
+/// The memory held by a workbook, by sheet and for the parts of the workbook no sheet owns.
+/// Rows shared by sheets copied from one another are counted in the first of them only.
+/// </summary>
+struct memory_report
+{
+    memory_usage workbook_parts;
+    std::vector<std::pair<std::string, memory_usage>> sheets;
+
+    memory_usage total() const;
+};
+
+} // namespace xlnt
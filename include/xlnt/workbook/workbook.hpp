@@ -30,11 +30,14 @@
 #include <vector>
 
 #include "../common/relationship.hpp"
+#include "memory_usage.hpp"
 
 namespace xlnt {
 
 class document_properties;
 class drawing;
+class load_options;
+class memory_resource;
 class range;
 class range_reference;
 class relationship;
@@ -95,6 +98,13 @@ public:
 
     //constructors
     workbook();
+
+    /// <summary>
+    /// Creates a workbook whose sheets allocate their row maps and cell tables from resource, which
+    /// has to outlive the workbook and its copies. The characters of cell strings, formulae and
+    /// comments, the styles, relationships and the rest come from the global heap.
+    /// </summary>
+    explicit workbook(memory_resource *resource);
     
     workbook &operator=(workbook other);
     workbook(workbook &&other);
@@ -161,6 +171,13 @@ public:
     bool load(const std::vector<unsigned char> &data);
     bool load(const std::string &filename);
     bool load(const std::istream &stream);
+
+    /// <summary>
+    /// Loads the sheets, rows and columns options selects, passing over the rest of the file.
+    /// </summary>
+    bool load(const std::vector<unsigned char> &data, const load_options &options);
+    bool load(const std::string &filename, const load_options &options);
+    bool load(const std::istream &stream, const load_options &options);
     
     bool operator==(const workbook &rhs) const;
     bool operator==(std::nullptr_t) const;
@@ -170,9 +187,20 @@ public:
 	void create_relationship(const std::string &id, const std::string &target, relationship::type type);
 	relationship get_relationship(const std::string &id) const;
     std::vector<relationship> get_relationships() const;
+
+    /// <summary>
+    /// Reports the bytes this workbook holds in memory by sheet and category.
+    /// </summary>
+    memory_report get_memory_usage() const;
+
+    memory_resource *get_memory_resource() const;
     
 private:
+    friend class cell;
+    friend class reader;
+    friend class style_writer;
     friend class worksheet;
+    friend class writer;
     std::shared_ptr<detail::workbook_impl> d_;
 };
     
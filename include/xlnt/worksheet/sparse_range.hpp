@@ -0,0 +1,108 @@
+// Copyright (c) 2014 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "range.hpp"
+#include "range_reference.hpp"
+#include "worksheet.hpp"
+
+namespace xlnt {
+
+namespace detail {
+struct cell_impl;
+} // namespace detail
+
+/// <summary>
+/// The populated cells of a range, those that garbage_collect would keep, visited in row-major
+/// or column-major order. Unlike range, the cells in between are neither visited nor created,
+/// so a large range over a sparse sheet costs about as much as the cells it contains. The rows
+/// stored in the range are found on construction and, in row-major order, the iterator finds
+/// the cells of each row as it reaches it. Column-major order has to see every row before it
+/// can hand out the first cell, so the cells are found on construction instead. Adding or
+/// removing cells in the range while iterating invalidates the iterators.
+/// </summary>
+class sparse_range
+{
+public:
+    sparse_range(worksheet ws, const range_reference &reference, major_order order = major_order::row);
+
+    /// <summary>
+    /// The number of populated cells, which in row-major order means walking the range.
+    /// </summary>
+    std::size_t size() const;
+
+    bool empty() const;
+
+    range_reference get_reference() const;
+
+    major_order get_order() const;
+
+    class iterator
+    {
+    public:
+        bool operator==(const iterator &rhs) const;
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+
+        iterator operator++(int);
+        iterator &operator++();
+
+        cell operator*() const;
+
+    private:
+        friend class sparse_range;
+
+        // positioned on the first populated cell of range, or at the end if at_end is true
+        iterator(const sparse_range &range, bool at_end);
+
+        // moves to the next populated cell, leaving current_ nullptr at the end
+        void advance();
+
+        const sparse_range *range_;
+
+        // the next entry of range_->rows_ to enter in row-major order, or of range_->cells_
+        std::size_t next_;
+
+        // the stored cells of the row being walked in row-major order, in column order
+        std::vector<detail::cell_impl *> row_cells_;
+        std::size_t row_position_;
+
+        detail::cell_impl *current_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    worksheet ws_;
+    range_reference ref_;
+    major_order order_;
+    column_t left_;
+    column_t right_;
+    std::vector<row_t> rows_;
+    std::vector<detail::cell_impl *> cells_;
+};
+
+} // namespace xlnt
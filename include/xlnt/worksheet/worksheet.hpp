@@ -43,6 +43,7 @@ class relationship;
 class workbook;
 
 struct date;
+struct memory_usage;
 
 namespace detail {    
 struct worksheet_impl;
@@ -287,8 +288,12 @@ public:
     
     // cell merge
     void merge_cells(const range_reference &reference);
+    void merge_cells(const std::vector<range_reference> &references);
     void unmerge_cells(const range_reference &reference);
     std::vector<range_reference> get_merged_ranges() const;
+    std::vector<range_reference> get_merged_ranges(const range_reference &overlapping) const;
+    bool has_merged_range(const cell_reference &reference) const;
+    range_reference get_merged_range(const cell_reference &reference) const;
     
     // append
     void append(const std::vector<std::string> &cells);
@@ -296,6 +301,9 @@ public:
     void append(const std::vector<date> &cells);
     void append(const std::unordered_map<std::string, std::string> &cells);
     void append(const std::unordered_map<int, std::string> &cells);
+    
+    // column
+    void set_column_values(const cell_reference &first_cell, const std::vector<std::string> &values);
 
     // operators
     bool operator==(const worksheet &other) const;
@@ -328,7 +336,18 @@ public:
     void decrement_comments();
     std::size_t get_comment_count() const;
 
+    /// <summary>
+    /// Reports the bytes this sheet holds in memory by category, including rows it shares
+    /// with sheets copied from it or that it was copied from.
+    /// </summary>
+    memory_usage get_memory_usage() const;
+
     void reserve(std::size_t n);
+
+    /// <summary>
+    /// Makes room for n cells in the row so that adding them doesn't rehash its cell table.
+    /// </summary>
+    void reserve_cells(row_t row, std::size_t n);
     
     header_footer &get_header_footer();
     const header_footer &get_header_footer() const;
@@ -340,6 +359,7 @@ public:
 private:
     friend class workbook;
     friend class cell;
+    friend class sparse_range;
     worksheet(detail::worksheet_impl *d);
     detail::worksheet_impl *d_;
 };
@@ -39,8 +39,16 @@ public:
     style_writer(workbook &wb);
     style_writer(const style_writer &);
     style_writer &operator=(const style_writer &);
+    
+    /// <summary>
+    /// Maps the style id of every style in the workbook (see cell::get_style_id) to its index in cellXfs.
+    /// </summary>
     std::unordered_map<std::size_t, std::string> get_style_by_hash() const;
     std::string write_table() const;
+    
+    /// <summary>
+    /// The distinct styles used in the workbook, the default style first.
+    /// </summary>
     std::vector<style> get_styles() const;
     
 private:
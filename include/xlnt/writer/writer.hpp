@@ -56,12 +56,21 @@ public:
 
 	static std::string write_root_rels();
 
+	static std::string write_root_rels(const workbook &wb);
+
     static std::string write_workbook_rels(const workbook &wb);
 
     static std::string write_worksheet_rels(worksheet ws);
 
 private:
+    friend class workbook;
+
 	static std::string write_relationships(const std::vector<relationship> &relationships);
+
+    // column_styles gives each column holding a styled cell that cell's style, which the public
+    // overload does whenever a style table is passed
+    static std::string write_worksheet(worksheet ws, const std::vector<std::string> &string_table,
+        const std::unordered_map<std::size_t, std::string> &style_table, bool column_styles);
 };
     
 } // namespace xlnt
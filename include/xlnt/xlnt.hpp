@@ -43,11 +43,14 @@ const std::string download_url = "https://github.com/tfussell/xlnt/archive/maste
 #include "writer/style_writer.hpp"
 #include "worksheet/range_reference.hpp"
 #include "worksheet/range.hpp"
+#include "worksheet/sparse_range.hpp"
 #include "common/exceptions.hpp"
 #include "reader/reader.hpp"
 #include "common/string_table.hpp"
 #include "common/zip_file.hpp"
+#include "common/memory_resource.hpp"
 #include "workbook/document_properties.hpp"
+#include "workbook/load_options.hpp"
 #include "cell/value.hpp"
 #include "cell/comment.hpp"
 #include "common/miniz.h"
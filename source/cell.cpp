@@ -1,6 +1,4 @@
 #include <algorithm>
-#include <locale>
-#include <sstream>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
@@ -12,99 +10,13 @@
 #include <xlnt/common/exceptions.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
 
 #include "detail/cell_impl.hpp"
-
-namespace {
-
-std::vector<std::string> split_string(const std::string &string, char delim = ' ')
-{
-    std::stringstream ss(string);
-    std::string part;
-    std::vector<std::string> parts;
-    while(std::getline(ss, part, delim))
-    {
-        parts.push_back(part);
-    }
-    return parts;
-}
-
-xlnt::value::type data_type_for_value(const std::string &value)
-{
-    if(value.empty())
-    {
-        return xlnt::value::type::null;
-    }
-
-    if(value[0] == '0')
-    {
-        if(value.length() > 1)
-        {
-            if(value[1] == '.' || (value.length() > 2 && (value[1] == 'e' || value[1] == 'E')))
-            {
-                auto first_non_number = std::find_if(value.begin() + 2, value.end(),
-                    [](char c) { return !std::isdigit(c, std::locale::classic()); });
-                if(first_non_number == value.end())
-                {
-                    return xlnt::value::type::numeric;
-                }
-            }
-            auto split = split_string(value, ':');
-            if(split.size() == 2 || split.size() == 3)
-            {
-                for(auto part : split)
-                {
-                    try
-                    {
-                        std::stoi(part);
-                    }
-                    catch(std::invalid_argument)
-                    {
-                        return xlnt::value::type::string;
-                    }
-                }
-                return xlnt::value::type::numeric;
-            }
-            else
-            {
-                return xlnt::value::type::string;
-            }
-        }
-        return xlnt::value::type::numeric;
-    }
-    else if(value[0] == '#')
-    {
-        return xlnt::value::type::error;
-    }
-    else
-    {
-        char *p;
-        strtod(value.c_str(), &p);
-        if(*p != 0)
-        {
-            static const std::vector<std::string> possible_booleans = {"TRUE", "true", "FALSE", "false"};
-            if(std::find(possible_booleans.begin(), possible_booleans.end(), value) != possible_booleans.end())
-            {
-                return xlnt::value::type::boolean;
-            }
-            if(value.back() == '%')
-            {
-                strtod(value.substr(0, value.length() - 1).c_str(), &p);
-                if(*p == 0)
-                {
-                    return xlnt::value::type::numeric;
-                }
-            }
-            return xlnt::value::type::string;
-        }
-        else
-        {
-            return xlnt::value::type::numeric;
-        }
-    }
-}
-
-} // namespace
+#include "detail/string_classifier.hpp"
+#include "detail/worksheet_impl.hpp"
+#include "detail/workbook_impl.hpp"
 
 namespace xlnt {
     
@@ -119,7 +31,7 @@ const std::unordered_map<std::string, int> cell::ErrorCodes =
     {"#REF!", 3},
     {"#NAME?", 4},
     {"#NUM!", 5},
-    {"#N/A!", 6}
+    {"#N/A", 6}
 };
 
 cell::cell() : d_(nullptr)
@@ -148,6 +60,7 @@ bool cell::garbage_collectible() const
 
 value &cell::get_value()
 {
+    d_->parent_->prepare_write(d_->row_);
     return d_->value_;
 }
 
@@ -158,11 +71,13 @@ const value &cell::get_value() const
 
 void cell::set_value(const value &v)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->value_ = v;
 }
 
 void cell::set_value(const std::string &s)
 {
+    d_->parent_->prepare_write(d_->row_);
     if(!get_parent().get_parent().get_guess_types())
     {
         d_->is_date_ = false;
@@ -170,40 +85,41 @@ void cell::set_value(const std::string &s)
     }
     else
     {
-        d_->is_date_ = false;
+        set_classified_value(s, detail::classify_string(s));
+    }
+}
 
-        switch(data_type_for_value(s))
-        {
-        case value::type::numeric:
-            if(s.find(':') != std::string::npos)
-            {
-                d_->is_date_ = true;
-                d_->value_ = value(time(s).to_number());
-            }
-            else if(s.back() == '%')
-            {
-                d_->value_ = value(std::stod(s.substr(0, s.length() - 1)) / 100);
-                get_style().get_number_format().set_format_code(xlnt::number_format::format::percentage);
-            }
-            else
-            {
-                d_->value_ = value(std::stod(s));
-            }
-            break;
-        case value::type::boolean:
-            d_->value_ = value(s == "TRUE" || s == "true");
-            break;
-        case value::type::error:
-            d_->value_ = value(s);
-            break;
-        case value::type::string:
-            d_->value_ = value(s);
-            break;
-        case value::type::null:
-            d_->value_ = value::null();
-            break;
-        default: throw data_type_exception();
-        }
+void cell::set_classified_value(const std::string &s, const detail::string_classification &classification)
+{
+    d_->parent_->prepare_write(d_->row_);
+    d_->is_date_ = false;
+
+    switch(classification.kind)
+    {
+    case detail::string_kind::number:
+        d_->value_ = value(classification.number);
+        break;
+    case detail::string_kind::percentage:
+        d_->value_ = value(classification.number);
+        set_number_format_code(xlnt::number_format::format::percentage);
+        break;
+    case detail::string_kind::time:
+        d_->is_date_ = true;
+        d_->value_ = value(classification.number);
+        break;
+    case detail::string_kind::boolean:
+        d_->value_ = value(classification.number != 0);
+        break;
+    case detail::string_kind::error:
+        d_->value_ = value::error(s);
+        break;
+    case detail::string_kind::text:
+        d_->value_ = value(s);
+        break;
+    case detail::string_kind::empty:
+        d_->value_ = value::null();
+        break;
+    default: throw data_type_exception();
     }
 }
 
@@ -214,59 +130,63 @@ void cell::set_value(const char *s)
 
 void cell::set_value(bool b)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->value_ = value(b);
 }
 
 void cell::set_value(int i)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->value_ = value(i);
 }
 
 void cell::set_value(long long int i)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->value_ = value(i);
 }
 
 void cell::set_value(double d)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->value_ = value(d);
 }
 
 void cell::set_value(const date &d)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->is_date_ = true;
-    auto date_format_code = xlnt::number_format::lookup_format(14);
-    auto number_format = xlnt::number_format(date_format_code);
-    get_style().set_number_format(number_format);
+    set_number_format_code(xlnt::number_format::lookup_format(14));
     auto base_date = get_parent().get_parent().get_properties().excel_base_date;
     set_value(d.to_number(base_date));
 }
 
 void cell::set_value(const datetime &d)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->is_date_ = true;
-    auto date_format_code = xlnt::number_format::lookup_format(22);
-    auto number_format = xlnt::number_format(date_format_code);
-    get_style().set_number_format(number_format);
+    set_number_format_code(xlnt::number_format::lookup_format(22));
     auto base_date = get_parent().get_parent().get_properties().excel_base_date;
     set_value(d.to_number(base_date));
 }
 
 void cell::set_value(const time &t)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->is_date_ = true;
     set_value(t.to_number());
 }
 
 void cell::set_value(const timedelta &t)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->is_date_ = true;
     set_value(t.to_number());
 }
 
 bool cell::has_style() const
 {
-    return d_->style_ != nullptr;
+    return d_->style_id_ != 0;
 }
 
 row_t cell::get_row() const
@@ -281,17 +201,23 @@ std::string cell::get_column() const
 
 void cell::set_merged(bool merged)
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->merged = merged;
 }
 
 bool cell::is_merged() const
 {
-    return d_->merged;
+    return d_->merged || d_->parent_->merged_cells_.find(cell_reference(d_->column_, d_->row_)) != nullptr;
 }
 
 bool cell::is_date() const
 {
-    return d_->is_date_ || (d_->style_ != nullptr && get_style().get_number_format().get_format_code() == number_format::format::date_xlsx14);
+    if(d_->is_date_)
+    {
+        return true;
+    }
+
+    return d_->value_.is(value::type::numeric) && detail::is_date_kind(get_style_registry().get_format_kind(d_->style_id_));
 }
 
 cell_reference cell::get_reference() const
@@ -316,25 +242,63 @@ bool cell::operator==(const cell &comparand) const
 
 style &cell::get_style()
 {
-    if(d_->style_ == nullptr)
+    d_->parent_->prepare_write(d_->row_);
+    auto &registry = get_style_registry();
+
+    // the returned style may be modified in place so this cell needs an entry of its own
+    if(!registry.is_detached(d_->style_id_))
     {
-        d_->style_ = new style();
+        d_->style_id_ = registry.detach(d_->style_id_);
     }
-    return *d_->style_;
+
+    return registry.get_mutable(d_->style_id_);
 }
 
 const style &cell::get_style() const
 {
-    if(d_->style_ == nullptr)
-    {
-        d_->style_ = new style();
-    }
-    return *d_->style_;
+    return get_style_registry().get(d_->style_id_);
 }
     
 void cell::set_style(const xlnt::style &s)
 {
-    get_style() = s;
+    d_->parent_->prepare_write(d_->row_);
+    auto &registry = get_style_registry();
+    auto previous_id = d_->style_id_;
+    d_->style_id_ = registry.intern(s);
+    registry.release(previous_id);
+}
+
+std::size_t cell::get_style_id() const
+{
+    return d_->style_id_;
+}
+
+void cell::set_style_id(std::size_t style_id)
+{
+    d_->parent_->prepare_write(d_->row_);
+    get_style_registry().release(d_->style_id_);
+    d_->style_id_ = style_id;
+}
+
+void cell::set_number_format_code(number_format::format format_code)
+{
+    d_->parent_->prepare_write(d_->row_);
+    auto &registry = get_style_registry();
+
+    if(registry.is_detached(d_->style_id_))
+    {
+        registry.get_mutable(d_->style_id_).get_number_format().set_format_code(format_code);
+        return;
+    }
+
+    style s = registry.get(d_->style_id_);
+    s.get_number_format().set_format_code(format_code);
+    d_->style_id_ = registry.intern(s);
+}
+
+detail::style_registry &cell::get_style_registry() const
+{
+    return d_->parent_->parent_->d_->styles_;
 }
 
 cell &cell::operator=(const cell &rhs)
@@ -370,6 +334,7 @@ bool cell::has_hyperlink() const
 
 void cell::set_hyperlink(const std::string &hyperlink)
 {
+    d_->parent_->prepare_write(d_->row_);
     if(hyperlink.length() == 0 || std::find(hyperlink.begin(), hyperlink.end(), ':') == hyperlink.end())
     {
         throw data_type_exception();
@@ -386,6 +351,7 @@ void cell::set_hyperlink(const std::string &hyperlink)
 
 void cell::set_formula(const std::string &formula)
 {
+    d_->parent_->prepare_write(d_->row_);
     if(formula.length() == 0)
     {
         throw data_type_exception();
@@ -411,11 +377,13 @@ std::string cell::get_formula() const
 
 void cell::clear_formula()
 {
+    d_->parent_->prepare_write(d_->row_);
     d_->formula_.clear();
 }
 
 void cell::set_comment(const xlnt::comment &c)
 {
+    d_->parent_->prepare_write(d_->row_);
     if(!has_comment())
     {
         get_parent().increment_comments();
@@ -426,6 +394,7 @@ void cell::set_comment(const xlnt::comment &c)
 
 void cell::clear_comment()
 {
+    d_->parent_->prepare_write(d_->row_);
     if(has_comment())
     {
         get_parent().decrement_comments();
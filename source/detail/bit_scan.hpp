@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The index of the lowest set bit. bits must not be zero.
+/// </summary>
+inline std::size_t count_trailing_zeros(std::uint64_t bits)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, bits);
+    return index;
+#elif defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#else
+    std::size_t count = 0;
+
+    while((bits & 1) == 0)
+    {
+        bits >>= 1;
+        count++;
+    }
+
+    return count;
+#endif
+}
+
+} // namespace detail
+} // namespace xlnt
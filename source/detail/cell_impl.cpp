@@ -4,11 +4,11 @@
 namespace xlnt {
 namespace detail {
 
-cell_impl::cell_impl() : parent_(nullptr), column_(0), row_(0), style_(nullptr), merged(false), is_date_(false), has_hyperlink_(false)
+cell_impl::cell_impl() : parent_(nullptr), column_(0), row_(0), style_id_(0), merged(false), is_date_(false), has_hyperlink_(false)
 {
 }
     
-cell_impl::cell_impl(worksheet_impl *parent, int column_index, int row_index) : parent_(parent), column_(column_index), row_(row_index), style_(nullptr), merged(false), is_date_(false), has_hyperlink_(false)
+cell_impl::cell_impl(worksheet_impl *parent, int column_index, int row_index) : parent_(parent), column_(column_index), row_(row_index), style_id_(0), merged(false), is_date_(false), has_hyperlink_(false)
 {
 }
     
@@ -16,6 +16,11 @@ cell_impl::cell_impl(const cell_impl &rhs) : is_date_(false)
 {
     *this = rhs;
 }
+
+cell_impl::cell_impl(cell_impl &&rhs) : is_date_(false)
+{
+    *this = std::move(rhs);
+}
     
 cell_impl &cell_impl::operator=(const cell_impl &rhs)
 {
@@ -25,10 +30,27 @@ cell_impl &cell_impl::operator=(const cell_impl &rhs)
     formula_ = rhs.formula_;
     column_ = rhs.column_;
     row_ = rhs.row_;
-    style_ = rhs.style_;
+    style_id_ = rhs.style_id_;
+    merged = rhs.merged;
+    is_date_ = rhs.is_date_;
+    has_hyperlink_ = rhs.has_hyperlink_;
+    comment_ = rhs.comment_;
+    return *this;
+}
+
+cell_impl &cell_impl::operator=(cell_impl &&rhs)
+{
+    parent_ = rhs.parent_;
+    value_ = std::move(rhs.value_);
+    hyperlink_ = std::move(rhs.hyperlink_);
+    formula_ = std::move(rhs.formula_);
+    column_ = rhs.column_;
+    row_ = rhs.row_;
+    style_id_ = rhs.style_id_;
     merged = rhs.merged;
     is_date_ = rhs.is_date_;
     has_hyperlink_ = rhs.has_hyperlink_;
+    comment_ = std::move(rhs.comment_);
     return *this;
 }
 
@@ -8,8 +8,6 @@
 
 namespace xlnt {
 
-class style;
-
 namespace detail {
 
 struct worksheet_impl;
@@ -19,7 +17,9 @@ struct cell_impl
     cell_impl();
     cell_impl(worksheet_impl *parent, int column_index, int row_index);
     cell_impl(const cell_impl &rhs);
+    cell_impl(cell_impl &&rhs);
     cell_impl &operator=(const cell_impl &rhs);
+    cell_impl &operator=(cell_impl &&rhs);
 
     worksheet_impl *parent_;
     value value_;
@@ -27,7 +27,7 @@ struct cell_impl
     relationship hyperlink_;
     column_t column_;
     row_t row_;
-    style *style_;
+    std::size_t style_id_;
     bool merged;
     bool is_date_;
     bool has_hyperlink_;
@@ -0,0 +1,166 @@
+#include <cctype>
+#include <vector>
+
+#include "format_classifier.hpp"
+
+namespace xlnt {
+namespace detail {
+
+format_kind classify_format(const std::string &format_code)
+{
+    std::vector<char> tokens;
+    bool elapsed = false;
+
+    for(std::size_t i = 0; i < format_code.size(); i++)
+    {
+        auto c = static_cast<char>(std::tolower(static_cast<unsigned char>(format_code[i])));
+
+        if(c == ';')
+        {
+            break;
+        }
+
+        if(c == '"')
+        {
+            i = format_code.find('"', i + 1);
+
+            if(i == std::string::npos)
+            {
+                break;
+            }
+        }
+        else if(c == '\\' || c == '_' || c == '*')
+        {
+            i++;
+        }
+        else if(c == '[')
+        {
+            auto end = format_code.find(']', i + 1);
+
+            if(end == std::string::npos)
+            {
+                break;
+            }
+
+            auto first = static_cast<char>(std::tolower(static_cast<unsigned char>(format_code[i + 1])));
+            bool repeated = end > i + 1 && (first == 'h' || first == 'm' || first == 's');
+
+            for(auto j = i + 1; repeated && j < end; j++)
+            {
+                repeated = std::tolower(static_cast<unsigned char>(format_code[j])) == first;
+            }
+
+            elapsed = elapsed || repeated;
+            i = end;
+        }
+        else if(c == 'a' && (format_code.compare(i, 5, "AM/PM") == 0 || format_code.compare(i, 5, "am/pm") == 0 || format_code.compare(i, 3, "A/P") == 0 || format_code.compare(i, 3, "a/p") == 0))
+        {
+            tokens.push_back('a');
+            i += format_code[i + 1] == '/' ? 2 : 4;
+        }
+        else if(c == 'y' || c == 'd' || c == 'm' || c == 'h' || c == 's' || c == '@' || c == '%')
+        {
+            tokens.push_back(c);
+        }
+        else if(c == 'g' && format_code.compare(i, 7, "General") == 0)
+        {
+            tokens.push_back('g');
+            i += 6;
+        }
+    }
+
+    if(elapsed)
+    {
+        return format_kind::duration;
+    }
+
+    bool has_date = false;
+    bool has_time = false;
+    bool has_text = false;
+    bool has_percentage = false;
+    bool has_general = false;
+
+    for(std::size_t i = 0; i < tokens.size(); i++)
+    {
+        switch(tokens[i])
+        {
+        case 'y':
+        case 'd':
+            has_date = true;
+            break;
+        case 'h':
+        case 's':
+        case 'a':
+            has_time = true;
+            break;
+        case 'm':
+        {
+            std::size_t previous = i;
+            while(previous > 0 && tokens[previous - 1] == 'm')
+            {
+                previous--;
+            }
+
+            std::size_t next = i;
+            while(next < tokens.size() && tokens[next] == 'm')
+            {
+                next++;
+            }
+
+            bool minutes = (previous > 0 && tokens[previous - 1] == 'h') || (next < tokens.size() && tokens[next] == 's');
+            (minutes ? has_time : has_date) = true;
+            i = next - 1;
+            break;
+        }
+        case '@':
+            has_text = true;
+            break;
+        case '%':
+            has_percentage = true;
+            break;
+        case 'g':
+            has_general = true;
+            break;
+        }
+    }
+
+    if(has_date && has_time)
+    {
+        return format_kind::datetime;
+    }
+
+    if(has_date)
+    {
+        return format_kind::date;
+    }
+
+    if(has_time)
+    {
+        return format_kind::time;
+    }
+
+    if(has_text)
+    {
+        return format_kind::text;
+    }
+
+    if(has_percentage)
+    {
+        return format_kind::percentage;
+    }
+
+    if(has_general || format_code.empty())
+    {
+        return format_kind::general;
+    }
+
+    return format_kind::number;
+}
+
+bool is_date_kind(format_kind kind)
+{
+    return kind == format_kind::date || kind == format_kind::time || kind == format_kind::datetime || kind == format_kind::duration;
+}
+
+} // namespace detail
+} // namespace xlnt
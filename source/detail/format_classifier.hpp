@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+enum class format_kind : unsigned char
+{
+    general,
+    number,
+    percentage,
+    text,
+    date,
+    time,
+    datetime,
+    duration
+};
+
+/// <summary>
+/// Classifies a number format code by the tokens in its first section. Quoted and escaped
+/// literals, padding, colours and locale or condition brackets are skipped, an "m" counts as
+/// minutes when it follows an hour or precedes seconds, and [h], [mm] or [ss] make a duration.
+/// </summary>
+format_kind classify_format(const std::string &format_code);
+
+/// <summary>
+/// True for the kinds whose values are serial dates or times.
+/// </summary>
+bool is_date_kind(format_kind kind);
+
+} // namespace detail
+} // namespace xlnt
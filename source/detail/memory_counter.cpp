@@ -0,0 +1,208 @@
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/value.hpp>
+#include <xlnt/common/relationship.hpp>
+#include <xlnt/common/zip_file.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/workbook.hpp>
+
+#include "memory_counter.hpp"
+#include "workbook_impl.hpp"
+#include "worksheet_impl.hpp"
+
+namespace {
+
+// the heap block behind a string, or nothing when the string fits in the object itself
+std::size_t string_bytes(const std::string &s)
+{
+    static const std::size_t InlineCapacity = std::string().capacity();
+    return s.capacity() > InlineCapacity ? s.capacity() + 1 : 0;
+}
+
+template<typename T>
+std::size_t vector_bytes(const std::vector<T> &v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+// the bucket array and the link and cached hash in every node, leaving the entries themselves
+// to the caller
+template<typename Map>
+std::size_t hash_table_bytes(const Map &map)
+{
+    return map.bucket_count() * sizeof(void *) + map.size() * 2 * sizeof(void *);
+}
+
+// the strings held by the keys of a string-keyed table
+template<typename Map>
+std::size_t key_bytes(const Map &map)
+{
+    std::size_t bytes = 0;
+
+    for(const auto &entry : map)
+    {
+        bytes += string_bytes(entry.first);
+    }
+
+    return bytes;
+}
+
+std::size_t relationship_bytes(const xlnt::relationship &rel)
+{
+    return string_bytes(rel.get_id()) + string_bytes(rel.get_source_uri()) + string_bytes(rel.get_target_uri());
+}
+
+std::size_t relationships_bytes(const std::vector<xlnt::relationship> &relationships)
+{
+    auto bytes = vector_bytes(relationships);
+
+    for(const auto &rel : relationships)
+    {
+        bytes += relationship_bytes(rel);
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+memory_usage memory_counter::count(const worksheet_impl &sheet, std::unordered_set<const void *> &counted)
+{
+    memory_usage usage;
+
+    usage.other += sizeof(worksheet_impl) + string_bytes(sheet.title_) + string_bytes(sheet.source_part_);
+
+    if(counted.insert(sheet.cell_map_.get()).second)
+    {
+        const auto &rows = *sheet.cell_map_;
+
+        usage.hash_tables += hash_table_bytes(rows) + rows.size() * sizeof(cell_map::value_type);
+
+        for(const auto &row : rows)
+        {
+            if(!counted.insert(row.second.get()).second)
+            {
+                continue;
+            }
+
+            const auto &cells = row.second->cells_;
+
+            // make_shared allocates the row and its reference counts together
+            usage.cells += sizeof(cell_row) + 2 * sizeof(long);
+            usage.hash_tables += hash_table_bytes(cells) + cells.size() * (sizeof(std::pair<const column_t, cell_impl>) - sizeof(cell_impl));
+
+            for(const auto &entry : cells)
+            {
+                const auto &cell = entry.second;
+
+                usage.cells += sizeof(cell_impl);
+                usage.strings += string_bytes(cell.value_.string_value_);
+                usage.formulas += string_bytes(cell.formula_);
+
+                if(cell.has_hyperlink_)
+                {
+                    usage.relationships += relationship_bytes(cell.hyperlink_);
+                }
+
+                usage.comments += string_bytes(cell.comment_.text_) + string_bytes(cell.comment_.author_);
+            }
+        }
+    }
+
+    usage.relationships += relationships_bytes(sheet.relationships_);
+
+    const auto &merged = sheet.merged_cells_;
+    usage.other += vector_bytes(merged.entries_) + vector_bytes(merged.trees_);
+
+    for(const auto &tree : merged.trees_)
+    {
+        usage.other += vector_bytes(tree.items) + vector_bytes(tree.nodes) + vector_bytes(tree.level_starts);
+    }
+
+    usage.hash_tables += hash_table_bytes(sheet.named_ranges_) + key_bytes(sheet.named_ranges_);
+    usage.other += sheet.named_ranges_.size() * sizeof(std::pair<const std::string, range_reference>);
+
+    usage.hash_tables += hash_table_bytes(sheet.row_properties_) + hash_table_bytes(sheet.column_dimensions_) + hash_table_bytes(sheet.row_dimensions_);
+    usage.other += sheet.row_properties_.size() * sizeof(std::pair<const row_t, row_properties>);
+    usage.other += sheet.column_dimensions_.size() * sizeof(std::pair<const column_t, double>);
+    usage.other += sheet.row_dimensions_.size() * sizeof(std::pair<const row_t, double>);
+
+    return usage;
+}
+
+memory_report memory_counter::count(const workbook_impl &book)
+{
+    memory_report report;
+    std::unordered_set<const void *> counted;
+
+    for(const auto &sheet : book.worksheets_)
+    {
+        report.sheets.push_back(std::make_pair(sheet->title_, count(*sheet, counted)));
+    }
+
+    auto &usage = report.workbook_parts;
+
+    usage.other += sizeof(workbook_impl) + vector_bytes(book.worksheets_) + vector_bytes(book.drawings_);
+
+    if(book.source_ != nullptr)
+    {
+        const auto &source = *book.source_;
+        usage.other += sizeof(zip_file) + vector_bytes(source.buffer_) + vector_bytes(source.entries_);
+        usage.hash_tables += hash_table_bytes(source.index_) + key_bytes(source.index_);
+        usage.hash_tables += source.index_.size() * sizeof(std::pair<const std::string, std::size_t>);
+    }
+
+    if(book.source_shared_strings_ != nullptr)
+    {
+        const auto &strings = *book.source_shared_strings_;
+        usage.strings += vector_bytes(strings);
+
+        for(const auto &s : strings)
+        {
+            usage.strings += string_bytes(s);
+        }
+    }
+
+    const auto &styles = book.styles_;
+    usage.styles += styles.styles_.size() * sizeof(style) + vector_bytes(styles.states_) + vector_bytes(styles.kinds_) + vector_bytes(styles.free_);
+    usage.styles += vector_bytes(book.source_style_ids_);
+
+    // the font names and custom number format codes of the entries
+    for(const auto &s : styles.styles_)
+    {
+        usage.styles += string_bytes(s.font_.name) + string_bytes(s.font_.scheme) + string_bytes(s.font_.color_.rgb);
+        usage.styles += string_bytes(s.number_format_.get_custom_format_code());
+    }
+
+    usage.hash_tables += hash_table_bytes(styles.index_);
+    usage.styles += styles.index_.size() * sizeof(std::pair<const std::size_t, std::size_t>);
+
+    usage.relationships += relationships_bytes(book.relationships_) + relationships_bytes(book.passthrough_root_relationships_);
+
+    usage.other += vector_bytes(book.passthrough_parts_) + vector_bytes(book.passthrough_content_types_) + string_bytes(book.workbook_content_type_);
+
+    for(const auto &part : book.passthrough_parts_)
+    {
+        usage.other += string_bytes(part);
+    }
+
+    for(const auto &type : book.passthrough_content_types_)
+    {
+        usage.other += string_bytes(type.extension) + string_bytes(type.part_name) + string_bytes(type.type);
+    }
+
+    usage.hash_tables += hash_table_bytes(book.sheet_titles_) + key_bytes(book.sheet_titles_);
+    usage.hash_tables += hash_table_bytes(book.named_range_sheets_) + key_bytes(book.named_range_sheets_);
+    usage.hash_tables += hash_table_bytes(book.relationship_ids_) + key_bytes(book.relationship_ids_);
+    usage.hash_tables += (book.sheet_titles_.size() + book.named_range_sheets_.size() + book.relationship_ids_.size()) * sizeof(std::pair<const std::string, std::size_t>);
+
+    return report;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <unordered_set>
+
+#include <xlnt/workbook/memory_usage.hpp>
+
+namespace xlnt {
+namespace detail {
+
+struct workbook_impl;
+struct worksheet_impl;
+
+/// <summary>
+/// Computes the memory held by sheets and workbooks from their internals. Sheets copied from
+/// one another share rows until they change, so the rows and row maps already counted are
+/// kept in counted and skipped when they are reached again.
+/// </summary>
+struct memory_counter
+{
+    static memory_usage count(const worksheet_impl &sheet, std::unordered_set<const void *> &counted);
+    static memory_report count(const workbook_impl &book);
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cmath>
+
+#include "merged_range_index.hpp"
+
+namespace {
+
+// the number of children of each node, and of items in each leaf
+const std::size_t NodeCapacity = 16;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+merged_range_index::merged_range_index() : erased_count_(0)
+{
+}
+
+merged_range_index::bounds merged_range_index::make_bounds(const range_reference &range)
+{
+    auto first = range.get_top_left();
+    auto last = range.get_bottom_right();
+
+    bounds result;
+    result.left = std::min(first.get_column_index(), last.get_column_index());
+    result.right = std::max(first.get_column_index(), last.get_column_index());
+    result.top = std::min(first.get_row_index(), last.get_row_index());
+    result.bottom = std::max(first.get_row_index(), last.get_row_index());
+
+    return result;
+}
+
+bool merged_range_index::overlaps(const bounds &a, const bounds &b)
+{
+    return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+}
+
+void merged_range_index::extend(bounds &a, const bounds &b)
+{
+    a.left = std::min(a.left, b.left);
+    a.right = std::max(a.right, b.right);
+    a.top = std::min(a.top, b.top);
+    a.bottom = std::max(a.bottom, b.bottom);
+}
+
+merged_range_index::tree merged_range_index::build(std::vector<std::size_t> items) const
+{
+    // sort-tile-recursive packing: the items are cut into vertical slices by column and each
+    // slice is ordered by row, so that the items of a leaf lie close together
+    auto leaf_count = (items.size() + NodeCapacity - 1) / NodeCapacity;
+    auto slice_count = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(leaf_count))));
+    auto slice_size = std::max<std::size_t>(1, slice_count) * NodeCapacity;
+
+    std::sort(items.begin(), items.end(), [this](std::size_t a, std::size_t b)
+    {
+        return entries_[a].box.left < entries_[b].box.left;
+    });
+
+    for(std::size_t start = 0; start < items.size(); start += slice_size)
+    {
+        auto end = std::min(start + slice_size, items.size());
+
+        std::sort(items.begin() + start, items.begin() + end, [this](std::size_t a, std::size_t b)
+        {
+            return entries_[a].box.top < entries_[b].box.top;
+        });
+    }
+
+    tree result;
+    result.level_starts.push_back(0);
+
+    for(std::size_t start = 0; start < items.size(); start += NodeCapacity)
+    {
+        auto box = entries_[items[start]].box;
+        auto end = std::min(start + NodeCapacity, items.size());
+
+        for(auto i = start + 1; i < end; i++)
+        {
+            extend(box, entries_[items[i]].box);
+        }
+
+        result.nodes.push_back(box);
+    }
+
+    result.level_starts.push_back(result.nodes.size());
+
+    // each level above groups consecutive nodes of the one below until a single root is left
+    while(result.nodes.size() - result.level_starts[result.level_starts.size() - 2] > 1)
+    {
+        auto level_start = result.level_starts[result.level_starts.size() - 2];
+        auto level_end = result.nodes.size();
+
+        for(auto start = level_start; start < level_end; start += NodeCapacity)
+        {
+            auto box = result.nodes[start];
+            auto end = std::min(start + NodeCapacity, level_end);
+
+            for(auto i = start + 1; i < end; i++)
+            {
+                extend(box, result.nodes[i]);
+            }
+
+            result.nodes.push_back(box);
+        }
+
+        result.level_starts.push_back(result.nodes.size());
+    }
+
+    result.items = std::move(items);
+
+    return result;
+}
+
+template<typename F>
+bool merged_range_index::search(const tree &t, const bounds &query, F visit) const
+{
+    if(t.nodes.empty())
+    {
+        return false;
+    }
+
+    return search(t, t.level_starts.size() - 2, 0, query, visit);
+}
+
+// calls visit with each live entry overlapping query below the node until visit returns true
+template<typename F>
+bool merged_range_index::search(const tree &t, std::size_t level, std::size_t node, const bounds &query, F &visit) const
+{
+    if(!overlaps(t.nodes[t.level_starts[level] + node], query))
+    {
+        return false;
+    }
+
+    auto first = node * NodeCapacity;
+
+    if(level == 0)
+    {
+        auto last = std::min(first + NodeCapacity, t.items.size());
+
+        for(auto i = first; i < last; i++)
+        {
+            const auto &candidate = entries_[t.items[i]];
+
+            if(!candidate.erased && overlaps(candidate.box, query) && visit(t.items[i]))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto last = std::min(first + NodeCapacity, t.level_starts[level] - t.level_starts[level - 1]);
+
+    for(auto child = first; child < last; child++)
+    {
+        if(search(t, level - 1, child, query, visit))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void merged_range_index::insert(const range_reference &range)
+{
+    entry added = {range, make_bounds(range), false};
+    entries_.push_back(added);
+
+    // like carrying in a binary counter, the new range and all trees no larger than what has
+    // been gathered so far are built into one
+    std::vector<std::size_t> items(1, entries_.size() - 1);
+
+    while(!trees_.empty() && trees_.back().items.size() <= items.size())
+    {
+        items.insert(items.end(), trees_.back().items.begin(), trees_.back().items.end());
+        trees_.pop_back();
+    }
+
+    trees_.push_back(build(std::move(items)));
+}
+
+void merged_range_index::insert(const std::vector<range_reference> &ranges)
+{
+    for(const auto &range : ranges)
+    {
+        entry added = {range, make_bounds(range), false};
+        entries_.push_back(added);
+    }
+
+    rebuild();
+}
+
+bool merged_range_index::erase(const range_reference &range)
+{
+    auto box = make_bounds(range);
+    auto found = entries_.size();
+
+    // the range may have been merged more than once, in which case the first is removed
+    for(const auto &t : trees_)
+    {
+        search(t, box, [&](std::size_t index)
+        {
+            if(entries_[index].range == range)
+            {
+                found = std::min(found, index);
+            }
+
+            return false;
+        });
+    }
+
+    if(found == entries_.size())
+    {
+        return false;
+    }
+
+    entries_[found].erased = true;
+    erased_count_++;
+
+    if(erased_count_ * 2 > entries_.size())
+    {
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const entry &e) { return e.erased; }), entries_.end());
+        erased_count_ = 0;
+        rebuild();
+    }
+
+    return true;
+}
+
+const range_reference *merged_range_index::find(const cell_reference &cell) const
+{
+    bounds point = {cell.get_column_index(), cell.get_column_index(), cell.get_row_index(), cell.get_row_index()};
+    const range_reference *found = nullptr;
+
+    for(const auto &t : trees_)
+    {
+        auto match = [&](std::size_t index)
+        {
+            found = &entries_[index].range;
+            return true;
+        };
+
+        if(search(t, point, match))
+        {
+            break;
+        }
+    }
+
+    return found;
+}
+
+std::vector<range_reference> merged_range_index::find_overlapping(const range_reference &range) const
+{
+    std::vector<std::size_t> matches;
+
+    for(const auto &t : trees_)
+    {
+        search(t, make_bounds(range), [&](std::size_t index)
+        {
+            matches.push_back(index);
+            return false;
+        });
+    }
+
+    std::sort(matches.begin(), matches.end());
+
+    std::vector<range_reference> result;
+    result.reserve(matches.size());
+
+    for(auto index : matches)
+    {
+        result.push_back(entries_[index].range);
+    }
+
+    return result;
+}
+
+std::vector<range_reference> merged_range_index::get_ranges() const
+{
+    std::vector<range_reference> result;
+    result.reserve(size());
+
+    for(const auto &e : entries_)
+    {
+        if(!e.erased)
+        {
+            result.push_back(e.range);
+        }
+    }
+
+    return result;
+}
+
+std::size_t merged_range_index::size() const
+{
+    return entries_.size() - erased_count_;
+}
+
+bool merged_range_index::empty() const
+{
+    return size() == 0;
+}
+
+void merged_range_index::rebuild()
+{
+    trees_.clear();
+
+    std::vector<std::size_t> items;
+    items.reserve(entries_.size());
+
+    for(std::size_t i = 0; i < entries_.size(); i++)
+    {
+        if(!entries_[i].erased)
+        {
+            items.push_back(i);
+        }
+    }
+
+    if(!items.empty())
+    {
+        trees_.push_back(build(std::move(items)));
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/common/types.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The merged ranges of a sheet in the order they were merged, indexed by packed R-trees so
+/// that the range containing a cell, or the ranges overlapping another, are found without
+/// looking at every range. A range list read from a file is built into a single tree, ranges
+/// merged one at a time go into a forest of trees whose sizes are distinct powers of two, and
+/// unmerged ranges are only marked until they outnumber the rest.
+/// </summary>
+class merged_range_index
+{
+public:
+    merged_range_index();
+
+    void insert(const range_reference &range);
+    void insert(const std::vector<range_reference> &ranges);
+
+    /// <summary>
+    /// Removes a range equal to the given one and returns false if there is none.
+    /// </summary>
+    bool erase(const range_reference &range);
+
+    /// <summary>
+    /// Returns a range containing the cell, or nullptr if it isn't merged.
+    /// </summary>
+    const range_reference *find(const cell_reference &cell) const;
+
+    /// <summary>
+    /// Returns the ranges that share at least one cell with the given range, in merge order.
+    /// </summary>
+    std::vector<range_reference> find_overlapping(const range_reference &range) const;
+
+    std::vector<range_reference> get_ranges() const;
+    std::size_t size() const;
+    bool empty() const;
+
+private:
+    friend struct memory_counter;
+
+    struct bounds
+    {
+        column_t left;
+        column_t right;
+        row_t top;
+        row_t bottom;
+    };
+
+    struct entry
+    {
+        range_reference range;
+        bounds box;
+        bool erased;
+    };
+
+    // a packed R-tree over some of the entries, stored level by level from the leaves up
+    struct tree
+    {
+        std::vector<std::size_t> items;
+        std::vector<bounds> nodes;
+        std::vector<std::size_t> level_starts;
+    };
+
+    static bounds make_bounds(const range_reference &range);
+    static bool overlaps(const bounds &a, const bounds &b);
+    static void extend(bounds &a, const bounds &b);
+
+    tree build(std::vector<std::size_t> items) const;
+
+    template<typename F>
+    bool search(const tree &t, const bounds &query, F visit) const;
+
+    template<typename F>
+    bool search(const tree &t, std::size_t level, std::size_t node, const bounds &query, F &visit) const;
+
+    void rebuild();
+
+    std::vector<entry> entries_;
+    std::size_t erased_count_;
+
+    // in decreasing size, each at most half as large as the one before it
+    std::vector<tree> trees_;
+};
+
+} // namespace detail
+} // namespace xlnt
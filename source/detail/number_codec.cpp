@@ -0,0 +1,583 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "number_codec.hpp"
+
+namespace {
+
+// Grisu2 as described in "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers" (Loitsch, 2010).
+
+struct diy_fp
+{
+    diy_fp() : f(0), e(0) {}
+    diy_fp(std::uint64_t significand, int exponent) : f(significand), e(exponent) {}
+
+    std::uint64_t f;
+    int e;
+};
+
+const std::uint64_t SignificandMask = 0x000FFFFFFFFFFFFFULL;
+const std::uint64_t ExponentMask = 0x7FF0000000000000ULL;
+const std::uint64_t HiddenBit = 0x0010000000000000ULL;
+const int ExponentBias = 0x3FF + 52;
+const int MinExponent = -ExponentBias;
+
+diy_fp subtract(const diy_fp &left, const diy_fp &right)
+{
+    return diy_fp(left.f - right.f, left.e);
+}
+
+diy_fp multiply(const diy_fp &left, const diy_fp &right)
+{
+    const std::uint64_t LowMask = 0xFFFFFFFF;
+
+    auto a = left.f >> 32;
+    auto b = left.f & LowMask;
+    auto c = right.f >> 32;
+    auto d = right.f & LowMask;
+
+    auto ac = a * c;
+    auto bc = b * c;
+    auto ad = a * d;
+    auto bd = b * d;
+
+    auto middle = (bd >> 32) + (ad & LowMask) + (bc & LowMask);
+    middle += 1ULL << 31; // round
+
+    return diy_fp(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), left.e + right.e + 64);
+}
+
+diy_fp normalize(diy_fp value)
+{
+    while((value.f & (1ULL << 63)) == 0)
+    {
+        value.f <<= 1;
+        value.e--;
+    }
+
+    return value;
+}
+
+diy_fp from_double(double number)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+
+    auto biased_exponent = static_cast<int>((bits & ExponentMask) >> 52);
+    auto significand = bits & SignificandMask;
+
+    if(biased_exponent != 0)
+    {
+        return diy_fp(significand + HiddenBit, biased_exponent - ExponentBias);
+    }
+
+    return diy_fp(significand, MinExponent + 1);
+}
+
+// Returns the normalized boundaries m- and m+ of v, both with the exponent of m+.
+void normalized_boundaries(const diy_fp &v, diy_fp &minus, diy_fp &plus)
+{
+    plus = diy_fp((v.f << 1) + 1, v.e - 1);
+
+    while((plus.f & (HiddenBit << 1)) == 0)
+    {
+        plus.f <<= 1;
+        plus.e--;
+    }
+
+    plus.f <<= 64 - 52 - 2;
+    plus.e -= 64 - 52 - 2;
+
+    minus = v.f == HiddenBit ? diy_fp((v.f << 2) - 1, v.e - 2) : diy_fp((v.f << 1) - 1, v.e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+}
+
+// Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340.
+const std::uint64_t CachedPowersSignificand[] =
+{
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+const std::int16_t CachedPowersExponent[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+diy_fp cached_power(int exponent, int &decimal_exponent)
+{
+    // 0.30102999566398114 = 1 / lg(10)
+    auto dk = (-61 - exponent) * 0.30102999566398114 + 347;
+    auto k = static_cast<int>(dk);
+
+    if(dk - k > 0.0)
+    {
+        k++;
+    }
+
+    auto index = static_cast<unsigned int>((k >> 3) + 1);
+    decimal_exponent = -(-348 + static_cast<int>(index << 3));
+
+    return diy_fp(CachedPowersSignificand[index], CachedPowersExponent[index]);
+}
+
+const std::uint64_t PowersOfTen[] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+void round_weed(char *buffer, int length, std::uint64_t delta, std::uint64_t rest, std::uint64_t ten_kappa, std::uint64_t distance)
+{
+    while(rest < distance && delta - rest >= ten_kappa
+        && (rest + ten_kappa < distance || distance - rest > rest + ten_kappa - distance))
+    {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+int count_digits(std::uint32_t n)
+{
+    int digits = 1;
+
+    while(n >= 10 && digits < 10)
+    {
+        n /= 10;
+        digits++;
+    }
+
+    return digits;
+}
+
+void generate_digits(const diy_fp &w, const diy_fp &upper, std::uint64_t delta, char *buffer, int &length, int &decimal_exponent)
+{
+    const diy_fp one(1ULL << -upper.e, upper.e);
+    const auto distance = subtract(upper, w).f;
+
+    auto integral = static_cast<std::uint32_t>(upper.f >> -one.e);
+    auto fractional = upper.f & (one.f - 1);
+    auto kappa = count_digits(integral);
+    length = 0;
+
+    while(kappa > 0)
+    {
+        auto divisor = static_cast<std::uint32_t>(PowersOfTen[kappa - 1]);
+        auto digit = integral / divisor;
+        integral %= divisor;
+
+        if(digit != 0 || length != 0)
+        {
+            buffer[length++] = static_cast<char>('0' + digit);
+        }
+
+        kappa--;
+        auto rest = (static_cast<std::uint64_t>(integral) << -one.e) + fractional;
+
+        if(rest <= delta)
+        {
+            decimal_exponent += kappa;
+            round_weed(buffer, length, delta, rest, PowersOfTen[kappa] << -one.e, distance);
+            return;
+        }
+    }
+
+    while(true)
+    {
+        fractional *= 10;
+        delta *= 10;
+        auto digit = static_cast<char>(fractional >> -one.e);
+
+        if(digit != 0 || length != 0)
+        {
+            buffer[length++] = static_cast<char>('0' + digit);
+        }
+
+        fractional &= one.f - 1;
+        kappa--;
+
+        if(fractional < delta)
+        {
+            decimal_exponent += kappa;
+            auto index = -kappa;
+            round_weed(buffer, length, delta, fractional, one.f, distance * (index < 20 ? PowersOfTen[index] : 0));
+            return;
+        }
+    }
+}
+
+// Writes the shortest digit string d such that d * 10^decimal_exponent round-trips to number.
+// number must be finite and positive.
+void grisu2(double number, char *buffer, int &length, int &decimal_exponent)
+{
+    const auto v = from_double(number);
+    diy_fp minus, plus;
+    normalized_boundaries(v, minus, plus);
+
+    const auto c_mk = cached_power(plus.e, decimal_exponent);
+    const auto w = multiply(normalize(v), c_mk);
+    auto upper = multiply(plus, c_mk);
+    auto lower = multiply(minus, c_mk);
+    lower.f++;
+    upper.f--;
+
+    generate_digits(w, upper, upper.f - lower.f, buffer, length, decimal_exponent);
+}
+
+char *write_exponent(int exponent, char *buffer)
+{
+    *buffer++ = 'E';
+
+    if(exponent < 0)
+    {
+        *buffer++ = '-';
+        exponent = -exponent;
+    }
+    else
+    {
+        *buffer++ = '+';
+    }
+
+    if(exponent >= 100)
+    {
+        *buffer++ = static_cast<char>('0' + exponent / 100);
+        exponent %= 100;
+        *buffer++ = static_cast<char>('0' + exponent / 10);
+    }
+    else if(exponent >= 10)
+    {
+        *buffer++ = static_cast<char>('0' + exponent / 10);
+    }
+
+    *buffer++ = static_cast<char>('0' + exponent % 10);
+
+    return buffer;
+}
+
+// Lays out length digits with decimal exponent k as plain decimal notation where that
+// stays short and as scientific notation otherwise. Returns the end of the string.
+char *prettify(char *buffer, int length, int k)
+{
+    const auto kk = length + k; // 10^(kk - 1) <= v < 10^kk
+
+    if(k >= 0 && kk <= 21)
+    {
+        // 1234e7 -> 12340000000
+        std::memset(buffer + length, '0', static_cast<std::size_t>(k));
+        return buffer + kk;
+    }
+
+    if(kk > 0 && kk <= 21)
+    {
+        // 1234e-2 -> 12.34
+        std::memmove(buffer + kk + 1, buffer + kk, static_cast<std::size_t>(length - kk));
+        buffer[kk] = '.';
+        return buffer + length + 1;
+    }
+
+    if(kk > -6 && kk <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        const auto offset = 2 - kk;
+        std::memmove(buffer + offset, buffer, static_cast<std::size_t>(length));
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', static_cast<std::size_t>(offset - 2));
+        return buffer + length + offset;
+    }
+
+    if(length == 1)
+    {
+        // 1e30 -> 1E+30
+        return write_exponent(kk - 1, buffer + 1);
+    }
+
+    // 1234e30 -> 1.234E+33
+    std::memmove(buffer + 2, buffer + 1, static_cast<std::size_t>(length - 1));
+    buffer[1] = '.';
+    return write_exponent(kk - 1, buffer + length + 1);
+}
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+const double ExactPowersOfTen[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::size_t format_number(double number, char *buffer)
+{
+    auto start = buffer;
+
+    if(number != number)
+    {
+        std::memcpy(buffer, "NaN", 4);
+        return 3;
+    }
+
+    if(std::signbit(number))
+    {
+        number = -number;
+
+        if(number != 0)
+        {
+            *buffer++ = '-';
+        }
+    }
+
+    if(number == 0)
+    {
+        *buffer++ = '0';
+        *buffer = '\0';
+        return static_cast<std::size_t>(buffer - start);
+    }
+
+    if(number > 1.7976931348623157e308)
+    {
+        std::memcpy(buffer, "INF", 4);
+        return static_cast<std::size_t>(buffer - start) + 3;
+    }
+
+    int length = 0;
+    int decimal_exponent = 0;
+    grisu2(number, buffer, length, decimal_exponent);
+    auto end = prettify(buffer, length, decimal_exponent);
+    *end = '\0';
+
+    return static_cast<std::size_t>(end - start);
+}
+
+std::string format_number(double number)
+{
+    char buffer[NumberBufferSize];
+    auto length = format_number(number, buffer);
+
+    return std::string(buffer, buffer + length);
+}
+
+bool parse_number(const char *first, const char *last, double &result)
+{
+    // Significant digits beyond this only contribute a sticky digit when falling back to strtod.
+    const std::size_t MaxDigits = 64;
+
+    char digits[MaxDigits + 24];
+    std::size_t digit_count = 0;
+    bool truncated = false;
+    bool any_digits = false;
+    int exponent = 0;
+
+    auto position = first;
+    bool negative = false;
+
+    if(position != last && (*position == '-' || *position == '+'))
+    {
+        negative = *position == '-';
+        ++position;
+    }
+
+    for(; position != last && is_digit(*position); ++position)
+    {
+        any_digits = true;
+
+        if(digit_count == 0 && *position == '0')
+        {
+            continue;
+        }
+
+        if(digit_count < MaxDigits)
+        {
+            digits[digit_count++] = *position;
+        }
+        else
+        {
+            truncated = truncated || *position != '0';
+            exponent++;
+        }
+    }
+
+    if(position != last && *position == '.')
+    {
+        ++position;
+
+        for(; position != last && is_digit(*position); ++position)
+        {
+            any_digits = true;
+
+            if(digit_count == 0 && *position == '0')
+            {
+                exponent--;
+                continue;
+            }
+
+            if(digit_count < MaxDigits)
+            {
+                digits[digit_count++] = *position;
+                exponent--;
+            }
+            else
+            {
+                truncated = truncated || *position != '0';
+            }
+        }
+    }
+
+    if(!any_digits)
+    {
+        return false;
+    }
+
+    if(position != last && (*position == 'e' || *position == 'E'))
+    {
+        ++position;
+        bool negative_exponent = false;
+
+        if(position != last && (*position == '-' || *position == '+'))
+        {
+            negative_exponent = *position == '-';
+            ++position;
+        }
+
+        if(position == last || !is_digit(*position))
+        {
+            return false;
+        }
+
+        int explicit_exponent = 0;
+
+        for(; position != last && is_digit(*position); ++position)
+        {
+            if(explicit_exponent < 100000)
+            {
+                explicit_exponent = explicit_exponent * 10 + (*position - '0');
+            }
+        }
+
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if(position != last)
+    {
+        return false;
+    }
+
+    if(digit_count == 0)
+    {
+        result = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    if(!truncated)
+    {
+        while(digits[digit_count - 1] == '0')
+        {
+            digit_count--;
+            exponent++;
+        }
+
+        // Clinger's fast path: both operands are exact so one IEEE operation rounds correctly.
+        if(digit_count <= 19 && exponent >= -22 && exponent <= 22)
+        {
+            std::uint64_t mantissa = 0;
+
+            for(std::size_t i = 0; i < digit_count; i++)
+            {
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(digits[i] - '0');
+            }
+
+            if(mantissa <= (1ULL << 53))
+            {
+                auto value = static_cast<double>(mantissa);
+                value = exponent < 0 ? value / ExactPowersOfTen[-exponent] : value * ExactPowersOfTen[exponent];
+                result = negative ? -value : value;
+                return true;
+            }
+        }
+    }
+
+    // Slow path: hand strtod a normalized "<digits>e<exponent>" string. It contains no decimal
+    // separator so the result doesn't depend on the current locale.
+    if(truncated)
+    {
+        digits[digit_count++] = '1';
+    }
+
+    digits[digit_count++] = 'e';
+
+    if(exponent < 0)
+    {
+        digits[digit_count++] = '-';
+        exponent = -exponent;
+    }
+
+    char exponent_digits[12];
+    std::size_t exponent_length = 0;
+
+    do
+    {
+        exponent_digits[exponent_length++] = static_cast<char>('0' + exponent % 10);
+        exponent /= 10;
+    } while(exponent != 0);
+
+    while(exponent_length > 0)
+    {
+        digits[digit_count++] = exponent_digits[--exponent_length];
+    }
+
+    digits[digit_count] = '\0';
+
+    auto value = std::strtod(digits, nullptr);
+
+    result = negative ? -value : value;
+
+    return true;
+}
+
+bool parse_number(const std::string &string, double &result)
+{
+    return parse_number(string.data(), string.data() + string.size(), result);
+}
+
+} // namespace detail
+} // namespace xlnt
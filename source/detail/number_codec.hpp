@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Large enough for any string produced by format_number, including the terminating null.
+/// </summary>
+const std::size_t NumberBufferSize = 32;
+
+/// <summary>
+/// Writes a decimal representation of number that reads back as exactly the same double
+/// (Grisu2) into buffer and returns the number of characters written. It is the shortest
+/// such representation for nearly all numbers but not for every one, 1e23 for example being
+/// written as "9.999999999999999E+22". The output is null-terminated, independent of the
+/// global locale and uses the SpreadsheetML form for exponents (e.g. "1.5E-7"). NaN and
+/// infinity are written as "NaN" and "INF", which aren't valid cell values.
+/// </summary>
+std::size_t format_number(double number, char *buffer);
+std::string format_number(double number);
+
+/// <summary>
+/// Parses the whole of [first, last) as a decimal number in the "C" locale.
+/// Returns false without throwing if the range is not entirely numeric. Like strtod, a
+/// number too large for a double gives HUGE_VAL with the number's sign.
+/// </summary>
+bool parse_number(const char *first, const char *last, double &result);
+bool parse_number(const std::string &string, double &result);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,85 @@
+#include <stdexcept>
+
+#include <xlnt/common/zip_file.hpp>
+
+#include "part_pipeline.hpp"
+
+namespace xlnt {
+namespace detail {
+
+part_pipeline::part_pipeline(zip_file &archive, const std::vector<std::string> &part_names, std::size_t capacity)
+    : capacity_(capacity),
+      remaining_(part_names.size()),
+      stopped_(false)
+{
+    producer_ = std::thread(&part_pipeline::inflate_parts, this, std::ref(archive), part_names);
+}
+
+part_pipeline::~part_pipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+
+    changed_.notify_all();
+    producer_.join();
+}
+
+std::string part_pipeline::next()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if(remaining_ == 0)
+    {
+        throw std::runtime_error("no parts left");
+    }
+
+    changed_.wait(lock, [this]() { return !parts_.empty() || error_ != nullptr; });
+
+    if(parts_.empty())
+    {
+        std::rethrow_exception(error_);
+    }
+
+    auto part = std::move(parts_.front());
+    parts_.pop_front();
+    remaining_--;
+
+    lock.unlock();
+    changed_.notify_all();
+
+    return part;
+}
+
+void part_pipeline::inflate_parts(zip_file &archive, const std::vector<std::string> &part_names)
+{
+    try
+    {
+        for(const auto &part_name : part_names)
+        {
+            auto part = archive.read(part_name);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this]() { return parts_.size() < capacity_ || stopped_; });
+
+            if(stopped_)
+            {
+                return;
+            }
+
+            parts_.push_back(std::move(part));
+            lock.unlock();
+            changed_.notify_all();
+        }
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::current_exception();
+        changed_.notify_all();
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
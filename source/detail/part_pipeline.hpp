@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xlnt {
+
+class zip_file;
+
+namespace detail {
+
+/// <summary>
+/// Inflates parts of an archive in order on a background thread, staying at most capacity
+/// parts ahead of the caller, so that each part is decompressed while the one before it is
+/// parsed. The archive must not be modified until the pipeline is destroyed.
+/// </summary>
+class part_pipeline
+{
+public:
+    part_pipeline(zip_file &archive, const std::vector<std::string> &part_names, std::size_t capacity);
+    ~part_pipeline();
+
+    /// <summary>
+    /// Returns the contents of the next part, waiting for it to be inflated if it isn't yet.
+    /// An exception thrown while inflating the part is rethrown here.
+    /// </summary>
+    std::string next();
+
+private:
+    void inflate_parts(zip_file &archive, const std::vector<std::string> &part_names);
+
+    std::size_t capacity_;
+    std::size_t remaining_;
+    std::deque<std::string> parts_;
+    std::exception_ptr error_;
+    bool stopped_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::thread producer_;
+};
+
+} // namespace detail
+} // namespace xlnt
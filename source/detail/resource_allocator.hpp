@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <xlnt/common/memory_resource.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A standard allocator drawing from a memory_resource, like std::pmr::polymorphic_allocator.
+/// Containers copied from one using it keep the same resource. All the members an allocator
+/// could have are spelled out for standard libraries that don't fill them in from allocator_traits.
+/// </summary>
+template<typename T>
+class resource_allocator
+{
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef resource_allocator<U> other;
+    };
+
+    resource_allocator() : resource_(default_resource())
+    {
+    }
+
+    resource_allocator(memory_resource *resource) : resource_(resource)
+    {
+    }
+
+    template<typename U>
+    resource_allocator(const resource_allocator<U> &other) : resource_(other.get_resource())
+    {
+    }
+
+    T *allocate(std::size_t count, const void * = nullptr)
+    {
+        return static_cast<T *>(resource_->allocate(count * sizeof(T), std::alignment_of<T>::value));
+    }
+
+    void deallocate(T *pointer, std::size_t count)
+    {
+        resource_->deallocate(pointer, count * sizeof(T), std::alignment_of<T>::value);
+    }
+
+    template<typename U, typename... Args>
+    void construct(U *pointer, Args &&... args)
+    {
+        ::new(static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U *pointer)
+    {
+        pointer->~U();
+    }
+
+    std::size_t max_size() const
+    {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+
+    T *address(T &value) const
+    {
+        return &value;
+    }
+
+    const T *address(const T &value) const
+    {
+        return &value;
+    }
+
+    memory_resource *get_resource() const
+    {
+        return resource_;
+    }
+
+private:
+    memory_resource *resource_;
+};
+
+template<typename T, typename U>
+bool operator==(const resource_allocator<T> &left, const resource_allocator<U> &right)
+{
+    return left.get_resource() == right.get_resource() || left.get_resource()->is_equal(*right.get_resource());
+}
+
+template<typename T, typename U>
+bool operator!=(const resource_allocator<T> &left, const resource_allocator<U> &right)
+{
+    return !(left == right);
+}
+
+} // namespace detail
+} // namespace xlnt
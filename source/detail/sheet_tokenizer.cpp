@@ -0,0 +1,775 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+#include "bit_scan.hpp"
+#include "sheet_tokenizer.hpp"
+
+namespace xlnt {
+namespace detail {
+namespace {
+
+const std::size_t BlockSize = 64;
+
+// one bit per byte of the 64 at block, set for '<', '>' and '"'
+std::uint64_t classify_block(const char *block)
+{
+#if defined(__AVX2__)
+    auto less = _mm256_set1_epi8('<');
+    auto greater = _mm256_set1_epi8('>');
+    auto quote = _mm256_set1_epi8('"');
+
+    std::uint64_t mask = 0;
+
+    for(std::size_t i = 0; i < BlockSize; i += 32)
+    {
+        auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+        auto matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, less), _mm256_cmpeq_epi8(bytes, greater)), _mm256_cmpeq_epi8(bytes, quote));
+        mask |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(matches))) << i;
+    }
+
+    return mask;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    auto less = _mm_set1_epi8('<');
+    auto greater = _mm_set1_epi8('>');
+    auto quote = _mm_set1_epi8('"');
+
+    std::uint64_t mask = 0;
+
+    for(std::size_t i = 0; i < BlockSize; i += 16)
+    {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+        auto matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, less), _mm_cmpeq_epi8(bytes, greater)), _mm_cmpeq_epi8(bytes, quote));
+        mask |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(matches))) << i;
+    }
+
+    return mask;
+#else
+    std::uint64_t mask = 0;
+
+    for(std::size_t i = 0; i < BlockSize; i++)
+    {
+        auto c = block[i];
+        mask |= static_cast<std::uint64_t>(c == '<' || c == '>' || c == '"') << i;
+    }
+
+    return mask;
+#endif
+}
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool equals(const char *name, std::size_t name_length, const char *literal)
+{
+    return std::strlen(literal) == name_length && std::memcmp(name, literal, name_length) == 0;
+}
+
+void append_utf8(unsigned long code_point, std::string &text)
+{
+    if(code_point < 0x80)
+    {
+        text.push_back(static_cast<char>(code_point));
+    }
+    else if(code_point < 0x800)
+    {
+        text.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if(code_point < 0x10000)
+    {
+        text.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        text.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        text.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+// converts the entity starting at position and moves position past it
+bool read_entity(const char *&position, const char *last, std::string &text)
+{
+    auto end = static_cast<const char *>(std::memchr(position, ';', static_cast<std::size_t>(last - position)));
+
+    if(end == nullptr)
+    {
+        return false;
+    }
+
+    auto name = position + 1;
+    auto name_length = static_cast<std::size_t>(end - name);
+    position = end + 1;
+
+    if(equals(name, name_length, "lt")) text.push_back('<');
+    else if(equals(name, name_length, "gt")) text.push_back('>');
+    else if(equals(name, name_length, "amp")) text.push_back('&');
+    else if(equals(name, name_length, "quot")) text.push_back('"');
+    else if(equals(name, name_length, "apos")) text.push_back('\'');
+    else if(name_length > 1 && name_length < 10 && name[0] == '#')
+    {
+        bool hex = name[1] == 'x';
+        unsigned long code_point = 0;
+
+        for(auto digit = name + (hex ? 2 : 1); digit < end; digit++)
+        {
+            if(*digit >= '0' && *digit <= '9') code_point = code_point * (hex ? 16 : 10) + static_cast<unsigned long>(*digit - '0');
+            else if(hex && *digit >= 'a' && *digit <= 'f') code_point = code_point * 16 + static_cast<unsigned long>(*digit - 'a' + 10);
+            else if(hex && *digit >= 'A' && *digit <= 'F') code_point = code_point * 16 + static_cast<unsigned long>(*digit - 'A' + 10);
+            else return false;
+        }
+
+        if(code_point == 0 || code_point > 0x10FFFF)
+        {
+            return false;
+        }
+
+        append_utf8(code_point, text);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// copies [first, last) to text, converting entities and line endings as pugixml does for
+// worksheets; element text consisting only of whitespace is dropped as pugixml drops it
+bool decode(const char *first, const char *last, bool attribute, std::string &text)
+{
+    text.clear();
+
+    if(!attribute && std::all_of(first, last, is_space))
+    {
+        return true;
+    }
+
+    auto plain = first;
+
+    while(plain < last && *plain != '&' && *plain != '\r')
+    {
+        plain++;
+    }
+
+    text.assign(first, plain);
+
+    for(auto position = plain; position < last;)
+    {
+        auto c = *position;
+
+        if(c == '&')
+        {
+            if(!read_entity(position, last, text))
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        if(c == '\r')
+        {
+            text.push_back('\n');
+            position += position + 1 < last && position[1] == '\n' ? 2 : 1;
+
+            continue;
+        }
+
+        text.push_back(c);
+        position++;
+    }
+
+    return true;
+}
+
+} // namespace
+
+structural_scanner::structural_scanner(const char *begin, const char *end)
+    : begin_(begin), end_(end), block_(nullptr), mask_(0)
+{
+}
+
+const char *structural_scanner::find(const char *position)
+{
+    auto size = static_cast<std::size_t>(end_ - begin_);
+    auto offset = static_cast<std::size_t>(position - begin_);
+
+    while(offset < size)
+    {
+        auto block_offset = offset & ~(BlockSize - 1);
+        auto block = begin_ + block_offset;
+
+        if(block != block_)
+        {
+            block_ = block;
+
+            if(size - block_offset >= BlockSize)
+            {
+                mask_ = classify_block(block);
+            }
+            else
+            {
+                // the last partial block is padded with bytes that never match
+                char padded[BlockSize] = {};
+                std::memcpy(padded, block, size - block_offset);
+                mask_ = classify_block(padded);
+            }
+        }
+
+        auto bits = mask_ & (~std::uint64_t(0) << (offset - block_offset));
+
+        if(bits != 0)
+        {
+            return block + count_trailing_zeros(bits);
+        }
+
+        offset = block_offset + BlockSize;
+    }
+
+    return end_;
+}
+
+sheet_tokenizer::sheet_tokenizer(const char *begin, const char *end)
+    : scanner_(begin, end), position_(begin), end_(end), in_row_(false), in_cell_(false), has_spans_(false)
+{
+}
+
+sheet_tokenizer::token sheet_tokenizer::next()
+{
+    if(in_cell_)
+    {
+        in_cell_ = false;
+
+        if(!skip_to_end_tag("c", 1))
+        {
+            return token::unsupported;
+        }
+    }
+
+    while(true)
+    {
+        position_ = find_tag(position_);
+
+        if(position_ == end_)
+        {
+            return in_row_ ? token::unsupported : token::end;
+        }
+
+        tag current;
+
+        if(!read_tag(current))
+        {
+            return token::unsupported;
+        }
+
+        if(current.closing)
+        {
+            if(!in_row_ || !equals(current.name, current.name_length, "row"))
+            {
+                return token::unsupported;
+            }
+
+            in_row_ = false;
+            continue;
+        }
+
+        if(!in_row_)
+        {
+            if(!equals(current.name, current.name_length, "row"))
+            {
+                return token::unsupported;
+            }
+
+            bool has_reference = false;
+            row_reference_.clear();
+            has_spans_ = false;
+            spans_.clear();
+
+            const char *name = nullptr;
+            std::size_t name_length = 0;
+            const char *value = nullptr;
+            const char *value_end = nullptr;
+
+            while(next_attribute(name, name_length, value, value_end))
+            {
+                if(!has_reference && equals(name, name_length, "r"))
+                {
+                    has_reference = true;
+
+                    if(!decode(value, value_end, true, row_reference_))
+                    {
+                        return token::unsupported;
+                    }
+                }
+                else if(!has_spans_ && equals(name, name_length, "spans"))
+                {
+                    has_spans_ = true;
+
+                    if(!decode(value, value_end, true, spans_))
+                    {
+                        return token::unsupported;
+                    }
+                }
+            }
+
+            if(!end_of_start_tag(current))
+            {
+                return token::unsupported;
+            }
+
+            in_row_ = !current.self_closing;
+
+            return token::row;
+        }
+
+        if(!equals(current.name, current.name_length, "c"))
+        {
+            return token::unsupported;
+        }
+
+        return read_cell() ? token::cell : token::unsupported;
+    }
+}
+
+const std::string &sheet_tokenizer::get_row_reference() const
+{
+    return row_reference_;
+}
+
+bool sheet_tokenizer::has_spans() const
+{
+    return has_spans_;
+}
+
+const std::string &sheet_tokenizer::get_spans() const
+{
+    return spans_;
+}
+
+bool sheet_tokenizer::skip_row()
+{
+    if(in_cell_)
+    {
+        in_cell_ = false;
+
+        if(!skip_to_end_tag("c", 1))
+        {
+            return false;
+        }
+    }
+
+    if(!in_row_)
+    {
+        return true;
+    }
+
+    in_row_ = false;
+
+    return skip_to_end_tag("row", 3);
+}
+
+const cell_markup &sheet_tokenizer::get_cell() const
+{
+    return cell_;
+}
+
+// moves past the next end tag with the given name; '<' can't appear in text or attribute
+// values, so each one found starts a tag and the tags in between needn't be read
+bool sheet_tokenizer::skip_to_end_tag(const char *name, std::size_t name_length)
+{
+    while(true)
+    {
+        position_ = find_tag(position_);
+
+        if(position_ == end_ || position_ + 1 == end_ || position_[1] == '!' || position_[1] == '?')
+        {
+            position_ = end_;
+            return false;
+        }
+
+        if(position_[1] == '/' && static_cast<std::size_t>(end_ - position_) > name_length + 2 && std::memcmp(position_ + 2, name, name_length) == 0
+            && (position_[name_length + 2] == '>' || is_space(position_[name_length + 2])))
+        {
+            tag end_tag;
+            return read_tag(end_tag);
+        }
+
+        position_++;
+    }
+}
+
+// the next '<' at or after position; quotes and '>' may appear in text
+const char *sheet_tokenizer::find_tag(const char *position)
+{
+    position = scanner_.find(position);
+
+    while(position != end_ && *position != '<')
+    {
+        position = scanner_.find(position + 1);
+    }
+
+    return position;
+}
+
+// reads the name of the next tag, skipping any text before it, and leaves position_ after the
+// name of a start tag or after the whole of an end tag
+bool sheet_tokenizer::read_tag(tag &result)
+{
+    position_ = find_tag(position_);
+
+    if(position_ == end_)
+    {
+        return false;
+    }
+
+    position_++;
+    result.closing = position_ != end_ && *position_ == '/';
+
+    if(result.closing)
+    {
+        position_++;
+    }
+
+    result.name = position_;
+
+    while(position_ != end_ && !is_space(*position_) && *position_ != '>' && *position_ != '/')
+    {
+        position_++;
+    }
+
+    result.name_length = static_cast<std::size_t>(position_ - result.name);
+    result.self_closing = false;
+
+    // comments, CDATA sections and processing instructions are left to the generic parser
+    if(result.name_length == 0 || *result.name == '!' || *result.name == '?')
+    {
+        position_ = end_;
+        return false;
+    }
+
+    if(result.closing)
+    {
+        while(position_ != end_ && is_space(*position_))
+        {
+            position_++;
+        }
+
+        if(position_ == end_ || *position_ != '>')
+        {
+            position_ = end_;
+            return false;
+        }
+
+        position_++;
+    }
+
+    return true;
+}
+
+// reads the next attribute of a start tag, returning false at the end of the tag or on markup
+// that isn't handled, in which case position_ is moved to the end so that the tag doesn't end
+bool sheet_tokenizer::next_attribute(const char *&name, std::size_t &name_length, const char *&value, const char *&value_end)
+{
+    while(position_ != end_ && is_space(*position_))
+    {
+        position_++;
+    }
+
+    if(position_ == end_ || *position_ == '>' || *position_ == '/')
+    {
+        return false;
+    }
+
+    name = position_;
+
+    while(position_ != end_ && *position_ != '=' && !is_space(*position_) && *position_ != '>' && *position_ != '/')
+    {
+        position_++;
+    }
+
+    name_length = static_cast<std::size_t>(position_ - name);
+
+    while(position_ != end_ && is_space(*position_))
+    {
+        position_++;
+    }
+
+    if(position_ == end_ || *position_ != '=')
+    {
+        position_ = end_;
+        return false;
+    }
+
+    position_++;
+
+    while(position_ != end_ && is_space(*position_))
+    {
+        position_++;
+    }
+
+    // single-quoted values are left to the generic parser
+    if(position_ == end_ || *position_ != '"')
+    {
+        position_ = end_;
+        return false;
+    }
+
+    value = position_ + 1;
+    auto quote = scanner_.find(value);
+
+    while(quote != end_ && *quote == '>')
+    {
+        quote = scanner_.find(quote + 1);
+    }
+
+    if(quote == end_ || *quote != '"')
+    {
+        position_ = end_;
+        return false;
+    }
+
+    value_end = quote;
+    position_ = quote + 1;
+
+    return true;
+}
+
+bool sheet_tokenizer::end_of_start_tag(tag &result)
+{
+    if(position_ == end_)
+    {
+        return false;
+    }
+
+    if(*position_ == '/')
+    {
+        if(position_ + 1 == end_ || position_[1] != '>')
+        {
+            return false;
+        }
+
+        result.self_closing = true;
+        position_ += 2;
+
+        return true;
+    }
+
+    position_++;
+
+    return true;
+}
+
+// reads the text of the element named name up to its end tag, which must follow the text directly
+bool sheet_tokenizer::read_text(const char *name, std::size_t name_length, std::string &text)
+{
+    auto text_end = find_tag(position_);
+    auto text_begin = position_;
+    position_ = text_end;
+
+    tag end_tag;
+
+    if(!read_tag(end_tag) || !end_tag.closing || end_tag.name_length != name_length || std::memcmp(end_tag.name, name, name_length) != 0)
+    {
+        return false;
+    }
+
+    return decode(text_begin, text_end, false, text);
+}
+
+bool sheet_tokenizer::read_cell()
+{
+    cell_.has_reference = false;
+    cell_.reference.clear();
+    cell_.has_type = false;
+    cell_.type.clear();
+    cell_.has_style = false;
+    cell_.style.clear();
+    cell_.has_value = false;
+    cell_.value.clear();
+    cell_.has_formula = false;
+    cell_.shared_formula = false;
+    cell_.formula.clear();
+    cell_.inline_text.clear();
+
+    const char *name = nullptr;
+    std::size_t name_length = 0;
+    const char *value = nullptr;
+    const char *value_end = nullptr;
+
+    while(next_attribute(name, name_length, value, value_end))
+    {
+        std::string *target = nullptr;
+
+        if(!cell_.has_reference && equals(name, name_length, "r"))
+        {
+            cell_.has_reference = true;
+            target = &cell_.reference;
+        }
+        else if(!cell_.has_type && equals(name, name_length, "t"))
+        {
+            cell_.has_type = true;
+            target = &cell_.type;
+        }
+        else if(!cell_.has_style && equals(name, name_length, "s"))
+        {
+            cell_.has_style = true;
+            target = &cell_.style;
+        }
+
+        if(target != nullptr && !decode(value, value_end, true, *target))
+        {
+            return false;
+        }
+    }
+
+    tag cell_tag;
+    cell_tag.self_closing = false;
+
+    if(!end_of_start_tag(cell_tag))
+    {
+        return false;
+    }
+
+    in_cell_ = !cell_tag.self_closing;
+
+    return true;
+}
+
+bool sheet_tokenizer::read_cell_content()
+{
+    if(!in_cell_)
+    {
+        return true;
+    }
+
+    in_cell_ = false;
+
+    const char *name = nullptr;
+    std::size_t name_length = 0;
+    const char *value = nullptr;
+    const char *value_end = nullptr;
+    bool has_inline_string = false;
+
+    while(true)
+    {
+        tag child;
+
+        if(!read_tag(child))
+        {
+            return false;
+        }
+
+        if(child.closing)
+        {
+            return equals(child.name, child.name_length, "c");
+        }
+
+        bool is_value = equals(child.name, child.name_length, "v");
+        bool is_formula = equals(child.name, child.name_length, "f");
+        bool is_inline_string = equals(child.name, child.name_length, "is");
+
+        // repeated children are left to the generic parser, which takes the first
+        if((!is_value && !is_formula && !is_inline_string) || (is_value && cell_.has_value) || (is_formula && cell_.has_formula) || (is_inline_string && has_inline_string))
+        {
+            return false;
+        }
+
+        while(next_attribute(name, name_length, value, value_end))
+        {
+            if(is_formula && !cell_.shared_formula && equals(name, name_length, "t"))
+            {
+                cell_.shared_formula = value_end - value == 6 && std::memcmp(value, "shared", 6) == 0;
+            }
+        }
+
+        if(!end_of_start_tag(child))
+        {
+            return false;
+        }
+
+        if(is_inline_string)
+        {
+            has_inline_string = true;
+
+            if(!child.self_closing && !read_inline_string())
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if(is_value)
+            {
+                cell_.has_value = true;
+            }
+            else
+            {
+                cell_.has_formula = true;
+            }
+
+            if(!child.self_closing && !read_text(child.name, child.name_length, is_value ? cell_.value : cell_.formula))
+            {
+                return false;
+            }
+        }
+    }
+}
+
+// reads the content of an is element, which must be a single t element
+bool sheet_tokenizer::read_inline_string()
+{
+    tag child;
+
+    if(!read_tag(child))
+    {
+        return false;
+    }
+
+    if(child.closing)
+    {
+        return equals(child.name, child.name_length, "is");
+    }
+
+    if(!equals(child.name, child.name_length, "t"))
+    {
+        return false;
+    }
+
+    const char *name = nullptr;
+    std::size_t name_length = 0;
+    const char *value = nullptr;
+    const char *value_end = nullptr;
+
+    while(next_attribute(name, name_length, value, value_end))
+    {
+    }
+
+    if(!end_of_start_tag(child))
+    {
+        return false;
+    }
+
+    if(!child.self_closing && !read_text(child.name, child.name_length, cell_.inline_text))
+    {
+        return false;
+    }
+
+    tag end_tag;
+
+    return read_tag(end_tag) && end_tag.closing && equals(end_tag.name, end_tag.name_length, "is");
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Finds the '<', '>' and '"' characters of a buffer, classifying 64 bytes at a time into a bit
+/// mask with AVX2 or SSE2 where the compiler targets them and with a plain loop otherwise.
+/// </summary>
+class structural_scanner
+{
+public:
+    structural_scanner(const char *begin, const char *end);
+
+    /// <summary>
+    /// Returns the first structural character at or after position, or the end of the buffer.
+    /// </summary>
+    const char *find(const char *position);
+
+private:
+    const char *begin_;
+    const char *end_;
+    const char *block_;
+    std::uint64_t mask_;
+};
+
+/// <summary>
+/// The parts of a c element that the reader uses, with entities and line endings converted
+/// the way the generic parser converts them in worksheets.
+/// </summary>
+struct cell_markup
+{
+    bool has_reference;
+    std::string reference;
+    bool has_type;
+    std::string type;
+    bool has_style;
+    std::string style;
+    bool has_value;
+    std::string value;
+    bool has_formula;
+    bool shared_formula;
+    std::string formula;
+    std::string inline_text;
+};
+
+/// <summary>
+/// Reads the rows and cells in the content of a sheetData element without building a tree.
+/// Only the markup that spreadsheet applications write is handled: unprefixed row, c, v, f
+/// and is/t elements with double-quoted attributes. Anything else, such as comments, CDATA,
+/// rich inline strings or malformed markup, makes next return unsupported so that the
+/// caller can read the sheet with the generic parser instead.
+/// </summary>
+class sheet_tokenizer
+{
+public:
+    enum class token
+    {
+        row,
+        cell,
+        end,
+        unsupported
+    };
+
+    sheet_tokenizer(const char *begin, const char *end);
+
+    token next();
+
+    /// <summary>
+    /// The r and spans attributes of the last row returned by next.
+    /// </summary>
+    const std::string &get_row_reference() const;
+    bool has_spans() const;
+    const std::string &get_spans() const;
+
+    /// <summary>
+    /// Moves past the end of the last row returned by next without reading its cells, which
+    /// are only looked at for the end tag, returning false on markup the tokenizer leaves to
+    /// the generic parser.
+    /// </summary>
+    bool skip_row();
+
+    /// <summary>
+    /// The last cell returned by next. Only its attributes are read by next; its value, formula
+    /// and inline string are read by read_cell_content, and skipped if next is called first.
+    /// </summary>
+    const cell_markup &get_cell() const;
+    bool read_cell_content();
+
+private:
+    struct tag
+    {
+        const char *name;
+        std::size_t name_length;
+        bool closing;
+        bool self_closing;
+    };
+
+    const char *find_tag(const char *position);
+    bool read_tag(tag &result);
+    bool read_text(const char *name, std::size_t name_length, std::string &text);
+    bool read_cell();
+    bool skip_to_end_tag(const char *name, std::size_t name_length);
+    bool read_inline_string();
+
+    bool next_attribute(const char *&name, std::size_t &name_length, const char *&value, const char *&value_end);
+    bool end_of_start_tag(tag &result);
+
+    structural_scanner scanner_;
+    const char *position_;
+    const char *end_;
+    bool in_row_;
+    bool in_cell_;
+    std::string row_reference_;
+    bool has_spans_;
+    std::string spans_;
+    cell_markup cell_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,45 @@
+#include <stdexcept>
+
+#include <xlnt/common/miniz.h>
+#include <xlnt/writer/writer.hpp>
+
+#include "static_parts.hpp"
+
+namespace xlnt {
+namespace detail {
+
+deflated_part deflate_part(const std::string &bytes)
+{
+    // zip entries hold a raw deflate stream, without the zlib header and adler-32 footer
+    auto flags = tdefl_create_comp_flags_from_zip_params(MZ_BEST_COMPRESSION, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    std::size_t compressed_size = 0;
+    auto compressed = tdefl_compress_mem_to_heap(bytes.data(), bytes.size(), &compressed_size, (int)flags);
+
+    if(compressed == nullptr)
+    {
+        throw std::runtime_error("compression failed");
+    }
+
+    deflated_part part;
+    part.data.assign(static_cast<const char *>(compressed), compressed_size);
+    part.size = bytes.size();
+    part.crc = (std::uint32_t)mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8 *>(bytes.data()), bytes.size());
+    mz_free(compressed);
+
+    return part;
+}
+
+const deflated_part &get_deflated_theme()
+{
+    static const deflated_part theme = deflate_part(writer::write_theme());
+    return theme;
+}
+
+const deflated_part &get_deflated_root_rels()
+{
+    static const deflated_part root_rels = deflate_part(writer::write_root_rels());
+    return root_rels;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The raw deflate stream of a part along with the size and CRC-32 of the uncompressed bytes,
+/// which is all zip_file::write_deflated needs to store the part without compressing it again.
+/// </summary>
+struct deflated_part
+{
+    std::string data;
+    std::size_t size;
+    std::uint32_t crc;
+};
+
+deflated_part deflate_part(const std::string &bytes);
+
+/// <summary>
+/// The theme and package relationships written for a new workbook never change, so each is
+/// serialised and compressed the first time it is needed and reused for the rest of the process.
+/// </summary>
+const deflated_part &get_deflated_theme();
+const deflated_part &get_deflated_root_rels();
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,237 @@
+#include <cmath>
+#include <cstring>
+
+#include <xlnt/cell/cell.hpp>
+#include <xlnt/common/datetime.hpp>
+
+#include "number_codec.hpp"
+#include "string_classifier.hpp"
+
+namespace {
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool equals(const char *first, const char *last, const char *literal)
+{
+    auto length = std::strlen(literal);
+    return static_cast<std::size_t>(last - first) == length && std::memcmp(first, literal, length) == 0;
+}
+
+bool is_boolean(const char *first, const char *last, bool &result)
+{
+    if(equals(first, last, "TRUE") || equals(first, last, "true"))
+    {
+        result = true;
+        return true;
+    }
+
+    if(equals(first, last, "FALSE") || equals(first, last, "false"))
+    {
+        result = false;
+        return true;
+    }
+
+    return false;
+}
+
+// compared in place so that classifying doesn't allocate
+bool is_error(const char *first, const char *last)
+{
+    for(const auto &error : xlnt::cell::ErrorCodes)
+    {
+        if(equals(first, last, error.first.c_str()))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Reads exactly count digits starting at position.
+bool read_digits(const char *&position, const char *last, int count, int &result)
+{
+    result = 0;
+
+    for(int i = 0; i < count; i++, ++position)
+    {
+        if(position == last || !is_digit(*position))
+        {
+            return false;
+        }
+
+        result = result * 10 + (*position - '0');
+    }
+
+    return true;
+}
+
+// h:mm, h:mm:ss and h:mm:ss.ffffff with one or two hour digits
+bool parse_time(const char *first, const char *last, double &result)
+{
+    auto position = first;
+    int hour = 0;
+
+    if(!read_digits(position, last, 1, hour))
+    {
+        return false;
+    }
+
+    if(position != last && is_digit(*position))
+    {
+        hour = hour * 10 + (*position++ - '0');
+    }
+
+    int minute = 0;
+
+    if(position == last || *position++ != ':' || !read_digits(position, last, 2, minute))
+    {
+        return false;
+    }
+
+    int second = 0;
+    int microsecond = 0;
+
+    if(position != last)
+    {
+        if(*position++ != ':' || !read_digits(position, last, 2, second))
+        {
+            return false;
+        }
+
+        if(position != last)
+        {
+            if(*position++ != '.' || position == last)
+            {
+                return false;
+            }
+
+            int scale = 100000;
+
+            for(; position != last; ++position)
+            {
+                if(!is_digit(*position))
+                {
+                    return false;
+                }
+
+                microsecond += (*position - '0') * scale;
+                scale /= 10;
+            }
+        }
+    }
+
+    if(minute > 59 || second > 59)
+    {
+        return false;
+    }
+
+    result = xlnt::time(hour, minute, second, microsecond).to_number();
+
+    return true;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+string_classification classify_string(const char *first, const char *last)
+{
+    string_classification result = {string_kind::text, 0};
+
+    if(first == last)
+    {
+        result.kind = string_kind::empty;
+        return result;
+    }
+
+    bool boolean = false;
+
+    switch(*first)
+    {
+    case '#':
+        if(is_error(first, last))
+        {
+            result.kind = string_kind::error;
+        }
+        return result;
+    case 't':
+    case 'T':
+    case 'f':
+    case 'F':
+        if(is_boolean(first, last, boolean))
+        {
+            result.kind = string_kind::boolean;
+            result.number = boolean ? 1 : 0;
+        }
+        return result;
+    default:
+        break;
+    }
+
+    // a leading zero followed by more digits is an identifier like a zip code unless it's a time
+    auto leading_zero = first[0] == '0' && last - first > 1 && is_digit(first[1]);
+    auto digits_end = first;
+
+    while(digits_end != last && is_digit(*digits_end))
+    {
+        ++digits_end;
+    }
+
+    if(digits_end != last && *digits_end == ':')
+    {
+        if(parse_time(first, last, result.number))
+        {
+            result.kind = string_kind::time;
+        }
+
+        return result;
+    }
+
+    if(leading_zero)
+    {
+        return result;
+    }
+
+    if(*(last - 1) == '%')
+    {
+        if(parse_number(first, last - 1, result.number) && std::isfinite(result.number))
+        {
+            result.kind = string_kind::percentage;
+            result.number /= 100;
+        }
+
+        return result;
+    }
+
+    // text too large for a double is kept as text rather than becoming infinity
+    if(parse_number(first, last, result.number) && std::isfinite(result.number))
+    {
+        result.kind = string_kind::number;
+    }
+
+    return result;
+}
+
+string_classification classify_string(const std::string &string)
+{
+    return classify_string(string.data(), string.data() + string.size());
+}
+
+void classify_strings(const std::vector<std::string> &strings, std::vector<string_classification> &classifications)
+{
+    classifications.resize(strings.size());
+    auto output = classifications.begin();
+
+    for(const auto &string : strings)
+    {
+        *output++ = classify_string(string);
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+enum class string_kind
+{
+    empty,
+    number,
+    percentage,
+    time,
+    boolean,
+    error,
+    text
+};
+
+/// <summary>
+/// What a string entered into a cell looks like when types are being guessed.
+/// number holds the parsed value for number, percentage (already divided by 100),
+/// time (as a fraction of a day) and boolean (0 or 1).
+/// </summary>
+struct string_classification
+{
+    string_kind kind;
+    double number;
+};
+
+/// <summary>
+/// Classifies and parses [first, last) in a single pass without allocating or throwing.
+/// </summary>
+string_classification classify_string(const char *first, const char *last);
+string_classification classify_string(const std::string &string);
+
+/// <summary>
+/// Classifies every string in a column, reusing the storage of classifications.
+/// </summary>
+void classify_strings(const std::vector<std::string> &strings, std::vector<string_classification> &classifications);
+
+} // namespace detail
+} // namespace xlnt
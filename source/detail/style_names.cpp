@@ -0,0 +1,109 @@
+#include <cstddef>
+
+#include "style_names.hpp"
+
+namespace {
+
+// each table is indexed by the underlying value of its enumeration
+const char *const FillTypeNames[] =
+{
+    "none", "solid", "linear", "path",
+    "darkDown", "darkGray", "darkGrid", "darkHorizontal", "darkTrellis", "darkUp", "darkVertical",
+    "gray0625", "gray125",
+    "lightDown", "lightGray", "lightGrid", "lightHorizontal", "lightTrellis", "lightUp", "lightVertical",
+    "mediumGray"
+};
+
+const char *const BorderStyleNames[] =
+{
+    "none", "dashDot", "dashDotDot", "dashed", "dotted", "double", "hair", "medium",
+    "mediumDashDot", "mediumDashDotDot", "mediumDashed", "slantDashDot", "thick", "thin"
+};
+
+const char *const UnderlineNames[] =
+{
+    "none", "double", "doubleAccounting", "single", "singleAccounting"
+};
+
+const char *const HorizontalAlignmentNames[] =
+{
+    "general", "left", "right", "center", "centerContinuous", "justify"
+};
+
+const char *const VerticalAlignmentNames[] =
+{
+    "bottom", "top", "center", "justify"
+};
+
+template<typename T, std::size_t N>
+bool find_name(const char *const (&names)[N], const std::string &name, T &result)
+{
+    for(std::size_t i = 0; i < N; i++)
+    {
+        if(name == names[i])
+        {
+            result = static_cast<T>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+std::string to_name(fill::type type)
+{
+    return FillTypeNames[static_cast<std::size_t>(type)];
+}
+
+std::string to_name(borders::border::style style)
+{
+    return BorderStyleNames[static_cast<std::size_t>(style)];
+}
+
+std::string to_name(font::underline underline)
+{
+    return UnderlineNames[static_cast<std::size_t>(underline)];
+}
+
+std::string to_name(alignment::horizontal_alignment horizontal)
+{
+    return HorizontalAlignmentNames[static_cast<std::size_t>(horizontal)];
+}
+
+std::string to_name(alignment::vertical_alignment vertical)
+{
+    return VerticalAlignmentNames[static_cast<std::size_t>(vertical)];
+}
+
+bool from_name(const std::string &name, fill::type &result)
+{
+    return find_name(FillTypeNames, name, result);
+}
+
+bool from_name(const std::string &name, borders::border::style &result)
+{
+    return find_name(BorderStyleNames, name, result);
+}
+
+bool from_name(const std::string &name, font::underline &result)
+{
+    return find_name(UnderlineNames, name, result);
+}
+
+bool from_name(const std::string &name, alignment::horizontal_alignment &result)
+{
+    return find_name(HorizontalAlignmentNames, name, result);
+}
+
+bool from_name(const std::string &name, alignment::vertical_alignment &result)
+{
+    return find_name(VerticalAlignmentNames, name, result);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include <xlnt/styles/alignment.hpp>
+#include <xlnt/styles/borders.hpp>
+#include <xlnt/styles/fill.hpp>
+#include <xlnt/styles/font.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// SpreadsheetML attribute values for the style enumerations. The from_name overloads leave
+/// result unchanged and return false for names they don't recognise.
+/// </summary>
+std::string to_name(fill::type type);
+std::string to_name(borders::border::style style);
+std::string to_name(font::underline underline);
+std::string to_name(alignment::horizontal_alignment horizontal);
+std::string to_name(alignment::vertical_alignment vertical);
+
+bool from_name(const std::string &name, fill::type &result);
+bool from_name(const std::string &name, borders::border::style &result);
+bool from_name(const std::string &name, font::underline &result);
+bool from_name(const std::string &name, alignment::horizontal_alignment &result);
+bool from_name(const std::string &name, alignment::vertical_alignment &result);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,140 @@
+#include "style_registry.hpp"
+
+namespace xlnt {
+namespace detail {
+
+style_registry::style_registry()
+{
+    intern(style());
+}
+
+std::size_t style_registry::intern(const style &s)
+{
+    auto hash = s.hash();
+    auto candidates = index_.equal_range(hash);
+
+    for(auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+    {
+        if(styles_[candidate->second] == s)
+        {
+            return candidate->second;
+        }
+    }
+
+    auto id = styles_.size();
+    styles_.push_back(s);
+    states_.push_back(entry_state::interned);
+    kinds_.push_back(classify_format(s.get_number_format().get_format_string()));
+    index_.emplace(hash, id);
+
+    return id;
+}
+
+std::size_t style_registry::detach(std::size_t id)
+{
+    if(free_.empty())
+    {
+        styles_.push_back(styles_.at(id));
+        states_.push_back(entry_state::detached);
+        kinds_.push_back(format_kind::general);
+        return styles_.size() - 1;
+    }
+
+    auto detached_id = free_.back();
+    free_.pop_back();
+    styles_[detached_id] = styles_.at(id);
+    states_[detached_id] = entry_state::detached;
+
+    return detached_id;
+}
+
+void style_registry::release(std::size_t id)
+{
+    if(is_detached(id))
+    {
+        styles_[id] = style();
+        states_[id] = entry_state::free;
+        free_.push_back(id);
+    }
+}
+
+void style_registry::release_unreferenced(const std::vector<bool> &referenced)
+{
+    for(std::size_t id = 0; id < styles_.size(); id++)
+    {
+        if(id >= referenced.size() || !referenced[id])
+        {
+            release(id);
+        }
+    }
+}
+
+bool style_registry::is_detached(std::size_t id) const
+{
+    return states_.at(id) == entry_state::detached;
+}
+
+std::size_t style_registry::size() const
+{
+    return styles_.size();
+}
+
+const style &style_registry::get(std::size_t id) const
+{
+    return styles_.at(id);
+}
+
+style &style_registry::get_mutable(std::size_t id)
+{
+    return styles_.at(id);
+}
+
+format_kind style_registry::get_format_kind(std::size_t id) const
+{
+    if(is_detached(id))
+    {
+        return classify_format(styles_[id].get_number_format().get_format_string());
+    }
+
+    return kinds_.at(id);
+}
+
+void style_registry::collect(std::vector<style> &distinct_styles, std::vector<std::size_t> &xf_ids) const
+{
+    distinct_styles.clear();
+    xf_ids.assign(styles_.size(), 0);
+
+    std::unordered_multimap<std::size_t, std::size_t> seen;
+
+    for(std::size_t id = 0; id < styles_.size(); id++)
+    {
+        if(states_[id] == entry_state::free)
+        {
+            continue;
+        }
+
+        auto hash = styles_[id].hash();
+        auto candidates = seen.equal_range(hash);
+        auto xf_id = distinct_styles.size();
+
+        for(auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+        {
+            if(distinct_styles[candidate->second] == styles_[id])
+            {
+                xf_id = candidate->second;
+                break;
+            }
+        }
+
+        if(xf_id == distinct_styles.size())
+        {
+            distinct_styles.push_back(styles_[id]);
+            seen.emplace(hash, xf_id);
+        }
+
+        xf_ids[id] = xf_id;
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
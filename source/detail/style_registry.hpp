@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/styles/style.hpp>
+
+#include "format_classifier.hpp"
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The styles used by a workbook. Cells refer to an entry by id, id 0 being the default style.
+/// Styles assigned through intern are deduplicated as they are assigned so that styles.xml
+/// can be written in time proportional to the number of distinct styles without visiting
+/// any cells. An entry handed out for in-place modification is detached: it belongs to a
+/// single cell and is only folded into the deduplicated table when the table is collected.
+/// Entries are kept in a deque so that a style handed out by get_mutable stays where it is
+/// while other entries are added.
+/// </summary>
+class style_registry
+{
+public:
+    style_registry();
+
+    /// <summary>
+    /// Returns the id of an entry equal to s, adding one if there is none.
+    /// </summary>
+    std::size_t intern(const style &s);
+
+    /// <summary>
+    /// Returns the id of a new detached entry initialised from the entry with the given id.
+    /// </summary>
+    std::size_t detach(std::size_t id);
+
+    /// <summary>
+    /// Recycles a detached entry that is no longer referenced. Interned entries are kept.
+    /// </summary>
+    void release(std::size_t id);
+
+    /// <summary>
+    /// Recycles every detached entry whose id is not marked in referenced, such as those of
+    /// cells that have since been removed.
+    /// </summary>
+    void release_unreferenced(const std::vector<bool> &referenced);
+
+    bool is_detached(std::size_t id) const;
+
+    /// <summary>
+    /// The number of entries, which only grows when a style is added or an entry is detached.
+    /// </summary>
+    std::size_t size() const;
+
+    const style &get(std::size_t id) const;
+    style &get_mutable(std::size_t id);
+
+    /// <summary>
+    /// The classification of the entry's number format. It is computed once when an entry is
+    /// interned; detached entries can change at any time and are classified on each call.
+    /// </summary>
+    format_kind get_format_kind(std::size_t id) const;
+
+    /// <summary>
+    /// Fills distinct_styles with every distinct style in use, the default style first,
+    /// and xf_ids with the position in distinct_styles of every entry id.
+    /// </summary>
+    void collect(std::vector<style> &distinct_styles, std::vector<std::size_t> &xf_ids) const;
+
+private:
+    friend struct memory_counter;
+
+    enum class entry_state : unsigned char
+    {
+        interned,
+        detached,
+        free
+    };
+
+    std::deque<style> styles_;
+    std::vector<entry_state> states_;
+    std::vector<format_kind> kinds_;
+    std::vector<std::size_t> free_;
+    std::unordered_multimap<std::size_t, std::size_t> index_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -1,20 +1,31 @@
 #pragma once
 
 #include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <xlnt/common/zip_file.hpp>
+
+#include "style_registry.hpp"
+#include "worksheet_impl.hpp"
+
 namespace xlnt {
 namespace detail {
 
 struct workbook_impl
 {
-    workbook_impl();
+    explicit workbook_impl(memory_resource *resource);
 
     workbook_impl &operator=(const workbook_impl &other)
     {
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
-        std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
+        for(const auto &sheet : other.worksheets_)
+        {
+            worksheets_.emplace_back(new worksheet_impl(*sheet));
+        }
         relationships_.clear();
         std::copy(other.relationships_.begin(), other.relationships_.end(), std::back_inserter(relationships_));
         drawings_.clear();
@@ -22,30 +33,168 @@ struct workbook_impl
         properties_ = other.properties_;
         guess_types_ = other.guess_types_;
         data_only_ = other.data_only_;
+        styles_ = other.styles_;
+        source_ = other.source_;
+        source_shared_strings_ = other.source_shared_strings_;
+        source_style_ids_ = other.source_style_ids_;
+        source_style_count_ = other.source_style_count_;
+        passthrough_parts_ = other.passthrough_parts_;
+        passthrough_content_types_ = other.passthrough_content_types_;
+        passthrough_root_relationships_ = other.passthrough_root_relationships_;
+        workbook_content_type_ = other.workbook_content_type_;
+        sheet_titles_ = other.sheet_titles_;
+        named_range_sheets_ = other.named_range_sheets_;
+        relationship_ids_ = other.relationship_ids_;
+        next_sheet_number_ = other.next_sheet_number_;
+        resource_ = other.resource_;
         return *this;
     }
 
     workbook_impl(const workbook_impl &other) 
         : active_sheet_index_(other.active_sheet_index_),
-        worksheets_(other.worksheets_), 
         relationships_(other.relationships_), 
         drawings_(other.drawings_), 
         properties_(other.properties_), 
         guess_types_(other.guess_types_),
-        data_only_(other.data_only_)
+        data_only_(other.data_only_),
+        styles_(other.styles_),
+        source_(other.source_),
+        source_shared_strings_(other.source_shared_strings_),
+        source_style_ids_(other.source_style_ids_),
+        source_style_count_(other.source_style_count_),
+        passthrough_parts_(other.passthrough_parts_),
+        passthrough_content_types_(other.passthrough_content_types_),
+        passthrough_root_relationships_(other.passthrough_root_relationships_),
+        workbook_content_type_(other.workbook_content_type_),
+        sheet_titles_(other.sheet_titles_),
+        named_range_sheets_(other.named_range_sheets_),
+        relationship_ids_(other.relationship_ids_),
+        next_sheet_number_(other.next_sheet_number_),
+        resource_(other.resource_)
+    {
+        for(const auto &sheet : other.worksheets_)
+        {
+            worksheets_.emplace_back(new worksheet_impl(*sheet));
+        }
+    }
+
+    workbook_impl(workbook_impl &&other)
+        : active_sheet_index_(other.active_sheet_index_),
+        worksheets_(std::move(other.worksheets_)),
+        relationships_(std::move(other.relationships_)),
+        drawings_(std::move(other.drawings_)),
+        properties_(std::move(other.properties_)),
+        guess_types_(other.guess_types_),
+        data_only_(other.data_only_),
+        styles_(std::move(other.styles_)),
+        source_(std::move(other.source_)),
+        source_shared_strings_(std::move(other.source_shared_strings_)),
+        source_style_ids_(std::move(other.source_style_ids_)),
+        source_style_count_(other.source_style_count_),
+        passthrough_parts_(std::move(other.passthrough_parts_)),
+        passthrough_content_types_(std::move(other.passthrough_content_types_)),
+        passthrough_root_relationships_(std::move(other.passthrough_root_relationships_)),
+        workbook_content_type_(std::move(other.workbook_content_type_)),
+        sheet_titles_(std::move(other.sheet_titles_)),
+        named_range_sheets_(std::move(other.named_range_sheets_)),
+        relationship_ids_(std::move(other.relationship_ids_)),
+        next_sheet_number_(other.next_sheet_number_),
+        resource_(other.resource_)
     {
-        
+    }
+
+    workbook_impl &operator=(workbook_impl &&other)
+    {
+        active_sheet_index_ = other.active_sheet_index_;
+        worksheets_ = std::move(other.worksheets_);
+        relationships_ = std::move(other.relationships_);
+        drawings_ = std::move(other.drawings_);
+        properties_ = std::move(other.properties_);
+        guess_types_ = other.guess_types_;
+        data_only_ = other.data_only_;
+        styles_ = std::move(other.styles_);
+        source_ = std::move(other.source_);
+        source_shared_strings_ = std::move(other.source_shared_strings_);
+        source_style_ids_ = std::move(other.source_style_ids_);
+        source_style_count_ = other.source_style_count_;
+        passthrough_parts_ = std::move(other.passthrough_parts_);
+        passthrough_content_types_ = std::move(other.passthrough_content_types_);
+        passthrough_root_relationships_ = std::move(other.passthrough_root_relationships_);
+        workbook_content_type_ = std::move(other.workbook_content_type_);
+        sheet_titles_ = std::move(other.sheet_titles_);
+        named_range_sheets_ = std::move(other.named_range_sheets_);
+        relationship_ids_ = std::move(other.relationship_ids_);
+        next_sheet_number_ = other.next_sheet_number_;
+        resource_ = other.resource_;
+        return *this;
     }
 
     //bool guess_types_;
     //bool data_only_;
     int active_sheet_index_;
-    std::vector<worksheet_impl> worksheets_;
+    // sheets are held by pointer so that worksheet handles and cells keep their addresses
+    // when sheets are added, removed or reordered
+    std::vector<std::unique_ptr<worksheet_impl>> worksheets_;
     std::vector<relationship> relationships_;
     std::vector<drawing> drawings_;
     document_properties properties_;
     bool guess_types_;
     bool data_only_;
+    style_registry styles_;
+
+    // the archive the workbook was loaded from and the string and xf tables its worksheets
+    // index into, which are reused on save for worksheets that have not been modified; neither
+    // the archive nor the string table is changed, so copies of the workbook share them
+    std::shared_ptr<zip_file> source_;
+    std::shared_ptr<const std::vector<std::string>> source_shared_strings_;
+    std::vector<std::size_t> source_style_ids_;
+    std::size_t source_style_count_;
+
+    // parts of the source archive that the workbook doesn't model, which are copied to the
+    // saved archive as they are along with the content types and relationships naming them
+    std::vector<std::string> passthrough_parts_;
+    std::vector<content_type> passthrough_content_types_;
+    std::vector<relationship> passthrough_root_relationships_;
+    std::string workbook_content_type_;
+
+    /// <summary>
+    /// Returns the position in worksheets_ of the first sheet with the given title or named range,
+    /// or worksheets_.size() if there is none.
+    /// </summary>
+    std::size_t find_sheet(const std::string &title) const;
+    std::size_t find_named_range(const std::string &name) const;
+
+    /// <summary>
+    /// Returns the position in worksheets_ of sheet, which is indexed under title, or
+    /// worksheets_.size() if this workbook doesn't own it.
+    /// </summary>
+    std::size_t find_position(const worksheet_impl *sheet, const std::string &title) const;
+
+    // the indices below have to be told about every change to worksheets_, relationships_ or
+    // to the titles and named ranges of the sheets
+    void add_relationship(const relationship &rel);
+    void add_sheet(std::unique_ptr<worksheet_impl> sheet);
+    void remove_sheet(std::size_t position);
+    void swap_sheets(std::size_t first, std::size_t second);
+    void retitle_sheet(const worksheet_impl *sheet, const std::string &old_title);
+    void add_named_range(const worksheet_impl *sheet, const std::string &name);
+    void remove_named_range(const worksheet_impl *sheet, const std::string &name);
+    void clear_indices();
+
+    void index_sheet(std::size_t position);
+    void unindex_sheet(std::size_t position);
+
+    // titles and names can be repeated, in which case lookups resolve to the first sheet having
+    // them, so each maps to the position of every sheet that has it
+    std::unordered_multimap<std::string, std::size_t> sheet_titles_;
+    std::unordered_multimap<std::string, std::size_t> named_range_sheets_;
+    std::unordered_map<std::string, std::size_t> relationship_ids_;
+
+    // every title SheetK with K below this is taken, so create_sheet can start looking here
+    std::size_t next_sheet_number_;
+
+    // where the sheets allocate their rows and cells, shared by copies of the workbook
+    memory_resource *resource_;
 };
 
 } // namespace detail
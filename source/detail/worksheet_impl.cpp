@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <cstdint>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+#include <xlnt/worksheet/worksheet.hpp>
+
+#include "bit_scan.hpp"
+#include "worksheet_impl.hpp"
+
+namespace xlnt {
+namespace detail {
+
+void worksheet_impl::operator=(worksheet_impl &&other)
+{
+    parent_ = other.parent_;
+    resource_ = other.resource_;
+    row_properties_ = std::move(other.row_properties_);
+    title_ = std::move(other.title_);
+    freeze_panes_ = other.freeze_panes_;
+    cell_map_ = std::move(other.cell_map_);
+    relationships_ = std::move(other.relationships_);
+    page_setup_ = other.page_setup_;
+    auto_filter_ = other.auto_filter_;
+    page_margins_ = other.page_margins_;
+    merged_cells_ = std::move(other.merged_cells_);
+    named_ranges_ = std::move(other.named_ranges_);
+    comment_count_ = other.comment_count_;
+    header_footer_ = other.header_footer_;
+    column_dimensions_ = std::move(other.column_dimensions_);
+    row_dimensions_ = std::move(other.row_dimensions_);
+    source_part_ = std::move(other.source_part_);
+    modified_ = other.modified_;
+
+    for(auto &row : *cell_map_)
+    {
+        if(row.second->owner_ != &other)
+        {
+            continue;
+        }
+
+        row.second->owner_ = this;
+
+        for(auto &cell : row.second->cells_)
+        {
+            cell.second.parent_ = this;
+        }
+    }
+}
+
+cell_map &worksheet_impl::get_rows()
+{
+    if(cell_map_.use_count() != 1)
+    {
+        cell_map_ = make_map(cell_map_.get());
+    }
+
+    return *cell_map_;
+}
+
+cell_row &worksheet_impl::get_row(row_t row)
+{
+    auto &shared_row = get_rows()[row];
+
+    if(shared_row == nullptr)
+    {
+        shared_row = make_row(nullptr);
+        shared_row->owner_ = this;
+    }
+    else if(shared_row->owner_ != this)
+    {
+        // another sheet's handles may point into the row, so this sheet takes a copy unless
+        // it holds the last reference to it
+        if(shared_row.use_count() != 1)
+        {
+            shared_row = make_row(shared_row.get());
+        }
+
+        shared_row->owner_ = this;
+
+        for(auto &cell : shared_row->cells_)
+        {
+            cell.second.parent_ = this;
+        }
+    }
+
+    return *shared_row;
+}
+
+void worksheet_impl::prepare_write(row_t row)
+{
+    modified_ = true;
+
+    auto match = cell_map_->find(row);
+
+    if(match == cell_map_->end() || match->second->owner_ != this)
+    {
+        return;
+    }
+
+    // the row is also shared when the whole map is
+    if(cell_map_.use_count() == 1 && match->second.use_count() == 1)
+    {
+        return;
+    }
+
+    // the cells being changed are where this sheet's handles point, so they are moved to a row
+    // of this sheet's own by swapping the maps, which keeps their addresses, and the row the
+    // other sheets hold is given a copy
+    auto &rows = get_rows();
+    auto &shared_row = rows[row];
+    auto own_row = make_row(nullptr);
+
+    own_row->owner_ = this;
+    std::swap(own_row->cells_, shared_row->cells_);
+    shared_row->cells_ = own_row->cells_;
+    shared_row->owner_ = nullptr;
+    shared_row = own_row;
+}
+
+void worksheet_impl::copy_rows()
+{
+    auto rows = make_map(nullptr);
+
+    for(const auto &row : *cell_map_)
+    {
+        auto copy = make_row(row.second.get());
+        copy->owner_ = this;
+
+        for(auto &cell : copy->cells_)
+        {
+            cell.second.parent_ = this;
+        }
+
+        rows->insert(std::make_pair(row.first, copy));
+    }
+
+    cell_map_ = rows;
+}
+
+std::shared_ptr<cell_row> worksheet_impl::make_row(const cell_row *copy) const
+{
+    resource_allocator<cell_row> allocator(resource_);
+
+    if(copy == nullptr)
+    {
+        return std::allocate_shared<cell_row>(allocator, resource_);
+    }
+
+    return std::allocate_shared<cell_row>(allocator, *copy, resource_);
+}
+
+std::shared_ptr<cell_map> worksheet_impl::make_map(const cell_map *copy) const
+{
+    resource_allocator<cell_map> allocator(resource_);
+
+    if(copy == nullptr)
+    {
+        return std::allocate_shared<cell_map>(allocator, 0, cell_map::hasher(), cell_map::key_equal(), allocator);
+    }
+
+    auto result = std::allocate_shared<cell_map>(allocator, copy->bucket_count(), cell_map::hasher(), cell_map::key_equal(), allocator);
+    result->insert(copy->begin(), copy->end());
+
+    return result;
+}
+
+std::vector<row_t> worksheet_impl::find_rows(row_t top, row_t bottom) const
+{
+    std::vector<row_t> rows;
+
+    if(cell_map_->size() <= bottom - top)
+    {
+        for(const auto &row : *cell_map_)
+        {
+            if(row.first >= top && row.first <= bottom)
+            {
+                rows.push_back(row.first);
+            }
+        }
+
+        std::sort(rows.begin(), rows.end());
+    }
+    else
+    {
+        for(auto row = top; row <= bottom; row++)
+        {
+            if(cell_map_->find(row) != cell_map_->end())
+            {
+                rows.push_back(row);
+            }
+        }
+    }
+
+    return rows;
+}
+
+std::vector<cell_reference> worksheet_impl::find_cells(const range_reference &range, major_order order) const
+{
+    auto top_left = range.get_top_left();
+    auto bottom_right = range.get_bottom_right();
+    auto left = std::min(top_left.get_column_index(), bottom_right.get_column_index());
+    auto right = std::max(top_left.get_column_index(), bottom_right.get_column_index());
+    auto top = std::min(top_left.get_row_index(), bottom_right.get_row_index());
+    auto bottom = std::max(top_left.get_row_index(), bottom_right.get_row_index());
+
+    auto rows = find_rows(top, bottom);
+    std::vector<cell_reference> result;
+    std::vector<column_t> columns;
+    std::vector<std::uint64_t> bitmap;
+
+    for(auto row : rows)
+    {
+        const auto &cells = cell_map_->at(row)->cells_;
+        columns.clear();
+
+        if(cells.size() <= right - left)
+        {
+            for(const auto &cell : cells)
+            {
+                if(cell.first >= left && cell.first <= right)
+                {
+                    columns.push_back(cell.first);
+                }
+            }
+
+            auto word_count = (right - left) / 64 + 1;
+
+            if(word_count <= columns.size())
+            {
+                bitmap.assign(word_count, 0);
+
+                for(auto column : columns)
+                {
+                    bitmap[(column - left) / 64] |= std::uint64_t(1) << ((column - left) % 64);
+                }
+
+                columns.clear();
+
+                for(std::size_t word = 0; word < word_count; word++)
+                {
+                    for(auto bits = bitmap[word]; bits != 0; bits &= bits - 1)
+                    {
+                        columns.push_back(left + static_cast<column_t>(word * 64 + count_trailing_zeros(bits)));
+                    }
+                }
+            }
+            else
+            {
+                std::sort(columns.begin(), columns.end());
+            }
+        }
+        else
+        {
+            for(auto column = left; column <= right; column++)
+            {
+                if(cells.find(column) != cells.end())
+                {
+                    columns.push_back(column);
+                }
+            }
+        }
+
+        for(auto column : columns)
+        {
+            result.push_back(cell_reference(column, row));
+        }
+    }
+
+    if(order == major_order::column)
+    {
+        // the cells of each column are already in row order
+        std::stable_sort(result.begin(), result.end(), [](const cell_reference &a, const cell_reference &b)
+        {
+            return a.get_column_index() < b.get_column_index();
+        });
+    }
+
+    return result;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -1,8 +1,15 @@
+#pragma once
+
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <xlnt/worksheet/range.hpp>
+
 #include "cell_impl.hpp"
+#include "merged_range_index.hpp"
+#include "resource_allocator.hpp"
 
 namespace xlnt {
 
@@ -10,11 +17,45 @@ class workbook;
 
 namespace detail {
 
+struct worksheet_impl;
+
+/// <summary>
+/// The cells of one row. Rows are shared by a sheet and the sheets copied from it until one of
+/// them changes the row, so that copying a sheet doesn't copy its cells.
+/// </summary>
+struct cell_row
+{
+    typedef std::unordered_map<column_t, cell_impl, std::hash<column_t>, std::equal_to<column_t>,
+        resource_allocator<std::pair<const column_t, cell_impl>>> cell_table;
+
+    explicit cell_row(memory_resource *resource)
+    : cells_(0, cell_table::hasher(), cell_table::key_equal(), resource), owner_(nullptr)
+    {
+    }
+
+    // a copy of other's cells allocated from resource, where copying the table would use other's
+    cell_row(const cell_row &other, memory_resource *resource)
+    : cells_(other.cells_.bucket_count(), cell_table::hasher(), cell_table::key_equal(), resource), owner_(nullptr)
+    {
+        cells_.insert(other.cells_.begin(), other.cells_.end());
+    }
+
+    cell_table cells_;
+
+    // the only sheet that may have handed out cells in this row, or nullptr if none has
+    worksheet_impl *owner_;
+};
+
+typedef std::unordered_map<row_t, std::shared_ptr<cell_row>, std::hash<row_t>, std::equal_to<row_t>,
+    resource_allocator<std::pair<const row_t, std::shared_ptr<cell_row>>>> cell_map;
+
 struct worksheet_impl
 {
-    worksheet_impl(workbook *parent_workbook, const std::string &title)
-    : parent_(parent_workbook), title_(title), freeze_panes_("A1"), comment_count_(0)
+    worksheet_impl(workbook *parent_workbook, const std::string &title, memory_resource *resource)
+    : parent_(parent_workbook), resource_(resource), title_(title), freeze_panes_("A1"), comment_count_(0), modified_(false)
     {
+        cell_map_ = make_map(nullptr);
+
         page_margins_.set_left(0.75);
         page_margins_.set_right(0.75);
         page_margins_.set_top(1);
@@ -27,20 +68,21 @@ struct worksheet_impl
     {
         *this = other;
     }
+
+    worksheet_impl(worksheet_impl &&other)
+    {
+        *this = std::move(other);
+    }
     
     void operator=(const worksheet_impl &other)
     {
         parent_ = other.parent_;
+        resource_ = other.resource_;
+        row_properties_ = other.row_properties_;
         title_ = other.title_;
         freeze_panes_ = other.freeze_panes_;
+        // rows are copied when either sheet first asks for a cell in them
         cell_map_ = other.cell_map_;
-        for(auto &row : cell_map_)
-        {
-            for(auto &cell : row.second)
-            {
-                cell.second.parent_ = this;
-            }
-        }
         relationships_ = other.relationships_;
         page_setup_ = other.page_setup_;
         auto_filter_ = other.auto_filter_;
@@ -49,23 +91,88 @@ struct worksheet_impl
         named_ranges_ = other.named_ranges_;
         comment_count_ = other.comment_count_;
         header_footer_ = other.header_footer_;
+        column_dimensions_ = other.column_dimensions_;
+        row_dimensions_ = other.row_dimensions_;
+        source_part_ = other.source_part_;
+        modified_ = other.modified_;
     }
+
+    /// <summary>
+    /// Takes other's cells without copying them. The rows other owned are given to this sheet
+    /// along with their cells, whose parent pointers are updated.
+    /// </summary>
+    void operator=(worksheet_impl &&other);
     
     workbook *parent_;
+
+    // where the rows and cells are allocated from, which has to outlive them
+    memory_resource *resource_;
+
     std::unordered_map<row_t, row_properties> row_properties_;
     std::string title_;
     cell_reference freeze_panes_;
-    std::unordered_map<row_t, std::unordered_map<column_t, cell_impl>> cell_map_;
+    std::shared_ptr<cell_map> cell_map_;
     std::vector<relationship> relationships_;
     page_setup page_setup_;
     range_reference auto_filter_;
     margins page_margins_;
-    std::vector<range_reference> merged_cells_;
+    merged_range_index merged_cells_;
     std::unordered_map<std::string, range_reference> named_ranges_;
     std::size_t comment_count_;
     header_footer header_footer_;
     std::unordered_map<column_t, double> column_dimensions_;
     std::unordered_map<row_t, double> row_dimensions_;
+
+    // the part this sheet was read from and whether anything written to that part has been
+    // changed since, so that workbook::save can copy the part from the source archive as is
+    std::string source_part_;
+    bool modified_;
+
+    /// <summary>
+    /// Returns the row's cells, adding the row if it is missing and copying it first if another
+    /// sheet may have handed out cells in it, so that cells can be handed out from it.
+    /// </summary>
+    cell_row &get_row(row_t row);
+
+    /// <summary>
+    /// Returns the map of rows, copying it first if it is shared with another sheet.
+    /// </summary>
+    cell_map &get_rows();
+
+    /// <summary>
+    /// Called before a cell of this sheet in the given row is changed. Marks the sheet modified and,
+    /// if the row is shared, gives the other sheets a copy of their own so that the change and
+    /// the cells handed out by this sheet stay in this sheet.
+    /// </summary>
+    void prepare_write(row_t row);
+
+    /// <summary>
+    /// Gives the sheet its own copy of every row, allocated from its own resource, so that it no
+    /// longer depends on the resource of the sheet it was copied from.
+    /// </summary>
+    void copy_rows();
+
+    /// <summary>
+    /// Returns a new row or map allocated from the sheet's resource, holding a copy of copy
+    /// unless it is nullptr.
+    /// </summary>
+    std::shared_ptr<cell_row> make_row(const cell_row *copy) const;
+    std::shared_ptr<cell_map> make_map(const cell_map *copy) const;
+
+    /// <summary>
+    /// Returns the cells stored in the range, in row-major or column-major order, without
+    /// adding any. The smaller of the range's rows and the sheet's stored rows is walked, and
+    /// likewise for the columns in each row. A row's columns come out in order from a bitmap
+    /// over the range's columns when that takes fewer words than the row has cells, and are
+    /// sorted otherwise.
+    /// </summary>
+    std::vector<cell_reference> find_cells(const range_reference &range, major_order order) const;
+
+    /// <summary>
+    /// Returns the stored rows from top to bottom inclusive in order, walking the smaller of the
+    /// span and the sheet's stored rows.
+    /// </summary>
+    std::vector<row_t> find_rows(row_t top, row_t bottom) const;
 };
 
 } // namespace detail
@@ -0,0 +1,44 @@
+#include "xml_part.hpp"
+
+namespace xlnt {
+namespace detail {
+namespace {
+
+unsigned int parse_options(xml_part_kind kind)
+{
+    switch(kind)
+    {
+    // only attributes are read, and none of them hold text in which whitespace matters
+    case xml_part_kind::package:
+        return pugi::parse_escapes;
+    // sheet names, defined names and number formats are attributes holding user text
+    case xml_part_kind::workbook:
+    case xml_part_kind::styles:
+        return pugi::parse_escapes | pugi::parse_wconv_attribute;
+    // cell values, formulas and strings are element text; the attributes read from a sheet are
+    // references, types and indices, which don't contain whitespace
+    case xml_part_kind::shared_strings:
+    case xml_part_kind::worksheet:
+    case xml_part_kind::properties:
+        return pugi::parse_escapes | pugi::parse_eol | pugi::parse_cdata;
+    }
+
+    return pugi::parse_default;
+}
+
+} // namespace
+
+void parse_part(pugi::xml_document &document, std::string &xml, xml_part_kind kind)
+{
+    // an empty string has no buffer to parse in place but also nothing to parse
+    if(xml.empty())
+    {
+        document.reset();
+        return;
+    }
+
+    document.load_buffer_inplace(&xml[0], xml.size(), parse_options(kind), pugi::encoding_utf8);
+}
+
+} // namespace detail
+} // namespace xlnt
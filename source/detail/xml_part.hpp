@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include <pugixml.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The kinds of package part the reader parses, which differ in what has to be converted.
+/// </summary>
+enum class xml_part_kind
+{
+    package,
+    workbook,
+    styles,
+    shared_strings,
+    worksheet,
+    properties
+};
+
+/// <summary>
+/// Parses xml into document in place, asking pugixml only for the conversions that the reader
+/// relies on for the given kind of part. Names and values in document point into xml, which
+/// is overwritten by parsing and has to outlive document.
+/// </summary>
+void parse_part(pugi::xml_document &document, std::string &xml, xml_part_kind kind);
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <xlnt/workbook/load_options.hpp>
+
+namespace xlnt {
+
+load_options::load_options() : has_rows_(false), first_row_(0), last_row_(0)
+{
+}
+
+void load_options::set_sheets(const std::vector<std::string> &titles)
+{
+    sheets_ = titles;
+}
+
+const std::vector<std::string> &load_options::get_sheets() const
+{
+    return sheets_;
+}
+
+bool load_options::includes_sheet(const std::string &title) const
+{
+    return sheets_.empty() || std::find(sheets_.begin(), sheets_.end(), title) != sheets_.end();
+}
+
+void load_options::set_columns(const std::vector<column_t> &columns)
+{
+    columns_ = columns;
+    std::sort(columns_.begin(), columns_.end());
+    columns_.erase(std::unique(columns_.begin(), columns_.end()), columns_.end());
+}
+
+const std::vector<column_t> &load_options::get_columns() const
+{
+    return columns_;
+}
+
+bool load_options::includes_column(column_t column) const
+{
+    return columns_.empty() || std::binary_search(columns_.begin(), columns_.end(), column);
+}
+
+void load_options::set_rows(row_t first, row_t last)
+{
+    if(first > last)
+    {
+        throw std::runtime_error("first row after last row");
+    }
+
+    has_rows_ = true;
+    first_row_ = first;
+    last_row_ = last;
+}
+
+void load_options::clear_rows()
+{
+    has_rows_ = false;
+    first_row_ = 0;
+    last_row_ = 0;
+}
+
+bool load_options::has_rows() const
+{
+    return has_rows_;
+}
+
+row_t load_options::get_first_row() const
+{
+    return first_row_;
+}
+
+row_t load_options::get_last_row() const
+{
+    return last_row_;
+}
+
+bool load_options::includes_row(row_t row) const
+{
+    return !has_rows_ || (row >= first_row_ && row <= last_row_);
+}
+
+bool load_options::is_projected() const
+{
+    return has_rows_ || !columns_.empty();
+}
+
+} // namespace xlnt
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include <xlnt/common/memory_resource.hpp>
+
+namespace {
+
+// blocks are aligned for any type a workbook stores
+const std::size_t BlockAlignment = std::alignment_of<long double>::value;
+
+class new_delete_resource : public xlnt::memory_resource
+{
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t /*alignment*/) override
+    {
+        // operator new aligns for any fundamental type, which covers everything a workbook stores
+        return ::operator new(bytes);
+    }
+
+    void do_deallocate(void *pointer, std::size_t /*bytes*/, std::size_t /*alignment*/) override
+    {
+        ::operator delete(pointer);
+    }
+};
+
+} // namespace
+
+namespace xlnt {
+
+memory_resource::~memory_resource()
+{
+}
+
+void *memory_resource::allocate(std::size_t bytes, std::size_t alignment)
+{
+    return do_allocate(bytes, alignment);
+}
+
+void memory_resource::deallocate(void *pointer, std::size_t bytes, std::size_t alignment)
+{
+    do_deallocate(pointer, bytes, alignment);
+}
+
+bool memory_resource::is_equal(const memory_resource &other) const
+{
+    return do_is_equal(other);
+}
+
+bool memory_resource::do_is_equal(const memory_resource &other) const
+{
+    return this == &other;
+}
+
+memory_resource *default_resource()
+{
+    static new_delete_resource resource;
+    return &resource;
+}
+
+monotonic_resource::monotonic_resource(std::size_t initial_block_size, memory_resource *upstream)
+    : upstream_(upstream),
+    next_block_size_(std::max<std::size_t>(initial_block_size, 64)),
+    current_(nullptr),
+    remaining_(0)
+{
+}
+
+monotonic_resource::~monotonic_resource()
+{
+    release();
+}
+
+void monotonic_resource::release()
+{
+    for(const auto &block : blocks_)
+    {
+        upstream_->deallocate(block.first, block.second, BlockAlignment);
+    }
+
+    blocks_.clear();
+    current_ = nullptr;
+    remaining_ = 0;
+}
+
+std::size_t monotonic_resource::get_reserved_size() const
+{
+    std::size_t size = 0;
+
+    for(const auto &block : blocks_)
+    {
+        size += block.second;
+    }
+
+    return size;
+}
+
+void *monotonic_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    auto padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+
+    if(current_ == nullptr || padding + bytes > remaining_)
+    {
+        // blocks grow geometrically so that the number of upstream allocations stays logarithmic
+        auto block_size = std::max(next_block_size_, bytes + alignment);
+        auto block = upstream_->allocate(block_size, BlockAlignment);
+
+        blocks_.push_back(std::make_pair(block, block_size));
+        next_block_size_ = block_size * 2;
+        current_ = static_cast<char *>(block);
+        remaining_ = block_size;
+        padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+    }
+
+    auto result = current_ + padding;
+    current_ += padding + bytes;
+    remaining_ -= padding + bytes;
+
+    return result;
+}
+
+void monotonic_resource::do_deallocate(void * /*pointer*/, std::size_t /*bytes*/, std::size_t /*alignment*/)
+{
+}
+
+} // namespace xlnt
@@ -0,0 +1,48 @@
+#include <xlnt/workbook/memory_usage.hpp>
+
+namespace xlnt {
+
+memory_usage::memory_usage()
+    : cells(0),
+    strings(0),
+    formulas(0),
+    styles(0),
+    relationships(0),
+    comments(0),
+    hash_tables(0),
+    other(0)
+{
+}
+
+std::size_t memory_usage::total() const
+{
+    return cells + strings + formulas + styles + relationships + comments + hash_tables + other;
+}
+
+memory_usage &memory_usage::operator+=(const memory_usage &rhs)
+{
+    cells += rhs.cells;
+    strings += rhs.strings;
+    formulas += rhs.formulas;
+    styles += rhs.styles;
+    relationships += rhs.relationships;
+    comments += rhs.comments;
+    hash_tables += rhs.hash_tables;
+    other += rhs.other;
+
+    return *this;
+}
+
+memory_usage memory_report::total() const
+{
+    auto result = workbook_parts;
+
+    for(const auto &sheet : sheets)
+    {
+        result += sheet.second;
+    }
+
+    return result;
+}
+
+} // namespace xlnt
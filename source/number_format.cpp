@@ -2,6 +2,8 @@
 
 #include <xlnt/styles/number_format.hpp>
 
+#include "detail/format_classifier.hpp"
+
 namespace xlnt {
 
 const std::unordered_map<number_format::format, std::string, number_format::format_hash> &number_format::format_strings()
@@ -171,4 +173,42 @@ number_format::format number_format::lookup_format(int code)
     return match->first;
 }
 
+bool number_format::is_date_format(const std::string &format)
+{
+    return detail::is_date_kind(detail::classify_format(format));
+}
+
+std::string number_format::get_format_string() const
+{
+    if(!custom_format_code_.empty())
+    {
+        return custom_format_code_;
+    }
+
+    auto match = format_strings().find(format_code_);
+
+    return match == format_strings().end() ? "General" : match->second;
+}
+
+std::size_t number_format::hash() const
+{
+    // a custom code takes precedence over the enumerated format
+    if(!custom_format_code_.empty())
+    {
+        return std::hash<std::string>()(custom_format_code_);
+    }
+
+    return std::hash<int>()((int)format_code_);
+}
+
+bool number_format::operator==(const number_format &other) const
+{
+    if(!custom_format_code_.empty() || !other.custom_format_code_.empty())
+    {
+        return custom_format_code_ == other.custom_format_code_;
+    }
+
+    return format_code_ == other.format_code_;
+}
+
 } // namespace xlnt
@@ -1,4 +1,8 @@
 #include <algorithm>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <thread>
 #include <pugixml.hpp>
 
 #include <xlnt/reader/reader.hpp>
@@ -9,9 +13,22 @@
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/common/relationship.hpp>
 #include <xlnt/common/zip_file.hpp>
 #include <xlnt/common/exceptions.hpp>
+#include <xlnt/styles/style.hpp>
+#include <xlnt/drawing/drawing.hpp>
+
+#include "constants.hpp"
+#include "detail/cell_impl.hpp"
+#include "detail/format_classifier.hpp"
+#include "detail/number_codec.hpp"
+#include "detail/sheet_tokenizer.hpp"
+#include "detail/style_names.hpp"
+#include "detail/worksheet_impl.hpp"
+#include "detail/workbook_impl.hpp"
+#include "detail/xml_part.hpp"
 
 namespace xlnt {
 
@@ -50,7 +67,7 @@ std::vector<std::pair<std::string, std::string>> reader::read_sheets(zip_file &a
 {
     auto xml_source = archive.read("xl/workbook.xml");
     pugi::xml_document doc;
-    doc.load(xml_source.c_str());
+    detail::parse_part(doc, xml_source, detail::xml_part_kind::workbook);
 
     std::string ns;
 
@@ -103,11 +120,11 @@ datetime w3cdtf_to_datetime(const std::string &string)
     return result;
 }
 
-document_properties reader::read_properties_core(const std::string &xml_string)
+document_properties reader::read_properties_core(std::string xml_string)
 {
     document_properties props;
     pugi::xml_document doc;
-    doc.load(xml_string.c_str());
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::properties);
     auto root_node = doc.child("cp:coreProperties");
 
     props.excel_base_date = calendar::windows_1900;
@@ -134,10 +151,10 @@ document_properties reader::read_properties_core(const std::string &xml_string)
     return props;
 }
 
-std::string reader::read_dimension(const std::string &xml_string)
+std::string reader::read_dimension(std::string xml_string)
 {
     pugi::xml_document doc;
-    doc.load(xml_string.c_str());
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::worksheet);
     auto root_node = doc.child("worksheet");
     auto dimension_node = root_node.child("dimension");
     std::string dimension = dimension_node.attribute("ref").as_string();
@@ -146,14 +163,22 @@ std::string reader::read_dimension(const std::string &xml_string)
 
 std::vector<relationship> reader::read_relationships(zip_file &archive, const std::string &filename)
 {
+    // an empty filename refers to the package itself, whose relationships are in _rels/.rels
     auto filename_separator_index = filename.find_last_of('/');
-    auto basename = filename.substr(filename_separator_index + 1);
-    auto dirname = filename.substr(0, filename_separator_index);
-    auto rels_filename = dirname + "/_rels/" + basename + ".rels";
+    std::string basename = filename;
+    std::string dirname;
+
+    if(filename_separator_index != std::string::npos)
+    {
+        basename = filename.substr(filename_separator_index + 1);
+        dirname = filename.substr(0, filename_separator_index);
+    }
+
+    auto rels_filename = (dirname.empty() ? std::string() : dirname + "/") + "_rels/" + basename + ".rels";
 
-    pugi::xml_document doc;
     auto content = archive.read(rels_filename);
-    doc.load(content.c_str());
+    pugi::xml_document doc;
+    detail::parse_part(doc, content, detail::xml_part_kind::package);
 
     auto root_node = doc.child("Relationships");
 
@@ -183,21 +208,36 @@ std::vector<relationship> reader::read_relationships(zip_file &archive, const st
 
 std::vector<std::pair<std::string, std::string>> reader::read_content_types(zip_file &archive)
 {
+    std::vector<std::pair<std::string, std::string>> default_types;
+    std::vector<std::pair<std::string, std::string>> override_types;
+    read_content_types(archive, default_types, override_types);
+
+    return override_types;
+}
+
+void reader::read_content_types(zip_file &archive, std::vector<std::pair<std::string, std::string>> &default_types, std::vector<std::pair<std::string, std::string>> &override_types)
+{
+    std::string content_types_string;
     pugi::xml_document doc;
 
     try
     {
-        auto content_types_string = archive.read("[Content_Types].xml");
-        doc.load(content_types_string.c_str());
+        content_types_string = archive.read("[Content_Types].xml");
+        detail::parse_part(doc, content_types_string, detail::xml_part_kind::package);
     }
-    catch(std::exception e)
+    catch(const std::exception &)
     {
         throw invalid_file_exception(archive.get_filename());
     }
 
     auto root_node = doc.child("Types");
 
-    std::vector<std::pair<std::string, std::string>> override_types;
+    for(auto child : root_node.children("Default"))
+    {
+        std::string extension = child.attribute("Extension").as_string();
+        std::string content_type = child.attribute("ContentType").as_string();
+        default_types.push_back({extension, content_type});
+    }
 
     for(auto child : root_node.children("Override"))
     {
@@ -205,8 +245,6 @@ std::vector<std::pair<std::string, std::string>> reader::read_content_types(zip_
         std::string content_type = child.attribute("ContentType").as_string();
         override_types.push_back({part_name, content_type});
     }
-
-    return override_types;
 }
 
 std::string reader::determine_document_type(const std::vector<std::pair<std::string, std::string>> &override_types)
@@ -220,7 +258,10 @@ std::string reader::determine_document_type(const std::vector<std::pair<std::str
 
     std::string type = match->second;
 
-    if(type == "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml")
+    if(type == "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml"
+        || type == "application/vnd.openxmlformats-officedocument.spreadsheetml.template.main+xml"
+        || type == "application/vnd.ms-excel.sheet.macroEnabled.main+xml"
+        || type == "application/vnd.ms-excel.template.macroEnabled.main+xml")
     {
         return "excel";
     }
@@ -236,116 +277,612 @@ std::string reader::determine_document_type(const std::vector<std::pair<std::str
     return "unsupported";
 }
 
-void read_worksheet_common(worksheet ws, const pugi::xml_node &root_node, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids)
+namespace {
+
+// sheets smaller than this are parsed on the calling thread, larger ones have their rows
+// split into chunks which are parsed on a thread each
+const std::size_t ParallelParseThreshold = 8 * 1024 * 1024;
+const std::size_t MinimumChunkSize = 2 * 1024 * 1024;
+
+// the fewest bytes of sheetData a row with a cell in it can take, as in <row><c/></row>
+const std::size_t MinimumRowSize = 16;
+
+// what a sheet says about one cell, read without touching the worksheet so that rows can be
+// read on several threads and applied to the worksheet in order afterwards
+struct parsed_cell
 {
-    auto dimension_node = root_node.child("dimension");
-    std::string dimension = dimension_node.attribute("ref").as_string();
-    auto sheet_data_node = root_node.child("sheetData");
-    auto merge_cells_node = root_node.child("mergeCells");
+    enum class value_kind
+    {
+        none,
+        text,
+        number,
+        boolean,
+        error,
+        shared_string
+    };
+
+    column_t column;
+    row_t row;
+    bool has_formula;
+    std::string formula;
+    bool has_style;
+    std::size_t style_id;
+    value_kind kind;
+    std::string text;
+    double number;
+    std::size_t shared_string_index;
+};
+
+// the rows and columns of a sheet that are read, numbered from 1 as in the markup
+struct projection
+{
+    projection() : first_row(0), last_row(std::numeric_limits<row_t>::max())
+    {
+    }
 
-    if(merge_cells_node != nullptr)
+    explicit projection(const load_options &options) : first_row(0), last_row(std::numeric_limits<row_t>::max())
     {
-        int count = merge_cells_node.attribute("count").as_int();
+        if(options.has_rows())
+        {
+            first_row = options.get_first_row() + 1;
+            last_row = options.get_last_row() == std::numeric_limits<row_t>::max() ? options.get_last_row() : options.get_last_row() + 1;
+        }
 
-        for(auto merge_cell_node : merge_cells_node.children("mergeCell"))
+        if(!options.get_columns().empty())
         {
-            ws.merge_cells(merge_cell_node.attribute("ref").as_string());
-            count--;
+            // no sheet has cells beyond MaxColumn, so columns past it needn't be marked
+            auto size = static_cast<std::size_t>(std::min(options.get_columns().back(), constants::MaxColumn)) + 2;
+            columns.assign(size, false);
+
+            for(auto column : options.get_columns())
+            {
+                if(static_cast<std::size_t>(column) + 1 < size)
+                {
+                    columns[column + 1] = true;
+                }
+            }
         }
+    }
 
-        if(count != 0)
+    bool includes_row(row_t row) const
+    {
+        return row >= first_row && row <= last_row;
+    }
+
+    bool includes_column(column_t column) const
+    {
+        return columns.empty() || (column < columns.size() && columns[column]);
+    }
+
+    row_t first_row;
+    row_t last_row;
+    // indexed by column, empty if every column is read
+    std::vector<bool> columns;
+};
+
+// everything about the workbook that reading a row depends on, all of it read-only
+struct row_context
+{
+    const std::vector<std::size_t> &style_ids;
+    const std::vector<detail::format_kind> &xf_kinds;
+    bool data_only;
+    bool base_date_1904;
+    const projection &selection;
+};
+
+// decodes the markup of the cell at column and row, skipping cells that set nothing
+void read_cell(const detail::cell_markup &markup, column_t column, row_t row, const row_context &context, std::vector<parsed_cell> &cells)
+{
+    parsed_cell parsed;
+    parsed.column = column;
+    parsed.row = row;
+    parsed.has_formula = false;
+    parsed.has_style = false;
+    parsed.style_id = 0;
+    parsed.kind = parsed_cell::value_kind::none;
+    parsed.number = 0;
+    parsed.shared_string_index = 0;
+
+    const auto &value_string = markup.value;
+    const auto &type = markup.type;
+
+    if(markup.has_formula && !markup.shared_formula && !context.data_only)
+    {
+        parsed.has_formula = true;
+        parsed.formula = markup.formula;
+    }
+
+    auto xf_kind = detail::format_kind::general;
+
+    if(markup.has_style)
+    {
+        auto xf_index = std::stoul(markup.style);
+
+        if(xf_index < context.style_ids.size())
         {
-            throw std::runtime_error("mismatch between count and actual number of merged cells");
+            parsed.has_style = true;
+            parsed.style_id = context.style_ids[xf_index];
+            xf_kind = context.xf_kinds[xf_index];
         }
     }
 
-    for(auto row_node : sheet_data_node.children("row"))
+    if(markup.has_type && type == "inlineStr") // inline string
+    {
+        parsed.kind = parsed_cell::value_kind::text;
+        parsed.text = markup.inline_text;
+    }
+    else if(markup.has_type && type == "s") // shared string
+    {
+        parsed.kind = parsed_cell::value_kind::shared_string;
+        parsed.shared_string_index = std::stoul(value_string);
+    }
+    else if(markup.has_type && type == "b") // boolean
+    {
+        parsed.kind = parsed_cell::value_kind::boolean;
+        parsed.number = value_string != "0" ? 1 : 0;
+    }
+    else if(markup.has_type && type == "e")
+    {
+        parsed.kind = parsed_cell::value_kind::error;
+        parsed.text = value_string;
+    }
+    else if(markup.has_type && type == "str")
+    {
+        parsed.kind = parsed_cell::value_kind::text;
+        parsed.text = value_string;
+    }
+    else if(markup.has_value) // a blank cell only has its style applied
+    {
+        double number = 0;
+
+        if(detail::parse_number(value_string, number))
+        {
+            // serial dates are kept relative to 1900 whatever the workbook's base date
+            if(markup.has_style && (xf_kind == detail::format_kind::date || xf_kind == detail::format_kind::datetime) && context.base_date_1904)
+            {
+                number += 1462;
+            }
+
+            parsed.kind = parsed_cell::value_kind::number;
+            parsed.number = number;
+        }
+        else
+        {
+            parsed.kind = parsed_cell::value_kind::text;
+            parsed.text = value_string;
+        }
+    }
+
+    if(parsed.has_formula || parsed.has_style || parsed.kind != parsed_cell::value_kind::none)
+    {
+        cells.push_back(std::move(parsed));
+    }
+}
+
+// reads the first and last column of a row's spans attribute, returning false if there is none
+bool read_spans(const std::string &span_string, int &min_column, int &max_column)
+{
+    auto colon_index = span_string.find(':');
+
+    if(colon_index == std::string::npos)
+    {
+        return false;
+    }
+
+    min_column = std::stoi(span_string.substr(0, colon_index));
+    max_column = std::stoi(span_string.substr(colon_index + 1));
+
+    return true;
+}
+
+void read_row(const pugi::xml_node &row_node, const row_context &context, std::vector<parsed_cell> &cells)
+{
+    row_t row_index = row_node.attribute("r").as_uint();
+    int min_column = 0;
+    int max_column = 0;
+
+    if(!context.selection.includes_row(row_index))
     {
-        int row_index = row_node.attribute("r").as_int();
-        std::string span_string = row_node.attribute("spans").as_string();
-        auto colon_index = span_string.find(':');
+        return;
+    }
 
-        if(colon_index == std::string::npos)
+    if(!read_spans(row_node.attribute("spans").as_string(), min_column, max_column))
+    {
+        return;
+    }
+
+    detail::cell_markup markup;
+
+    for(int i = min_column; i < max_column + 1; i++)
+    {
+        if(!context.selection.includes_column((column_t)i))
         {
             continue;
         }
 
-        int min_column = std::stoi(span_string.substr(0, colon_index));
-        int max_column = std::stoi(span_string.substr(colon_index + 1));
+        std::string address = xlnt::cell_reference::column_string_from_index(i) + std::to_string(row_index);
+        auto cell_node = row_node.find_child_by_attribute("c", "r", address.c_str());
 
-        for(int i = min_column; i < max_column + 1; i++)
+        if(cell_node == nullptr)
         {
-            std::string address = xlnt::cell_reference::column_string_from_index(i) + std::to_string(row_index);
-            auto cell_node = row_node.find_child_by_attribute("c", "r", address.c_str());
+            continue;
+        }
 
-            if(cell_node != nullptr)
-            {
-                bool has_value = cell_node.child("v") != nullptr;
-                std::string value_string = cell_node.child("v").text().as_string();
+        markup.has_value = cell_node.child("v") != nullptr;
+        markup.value = cell_node.child("v").text().as_string();
+        markup.has_type = cell_node.attribute("t") != nullptr;
+        markup.type = cell_node.attribute("t").as_string();
+        markup.has_style = cell_node.attribute("s") != nullptr;
+        markup.style = cell_node.attribute("s").as_string();
+        markup.has_formula = cell_node.child("f") != nullptr;
+        markup.shared_formula = markup.has_formula && cell_node.child("f").attribute("t") != nullptr && std::string(cell_node.child("f").attribute("t").as_string()) == "shared";
+        markup.formula = cell_node.child("f").text().as_string();
+        markup.inline_text = cell_node.child("is").child("t").text().as_string();
+
+        read_cell(markup, (column_t)i, row_index, context, cells);
+    }
+}
+
+// the column of a cell reference made of the given row's number preceded by column letters as
+// the generic reader writes them, or 0 for any other reference, which that reader never finds
+column_t read_column(const detail::cell_markup &markup, const std::string &row_string)
+{
+    const auto &reference = markup.reference;
+    std::size_t letters = 0;
+    column_t column = 0;
+
+    while(letters < reference.size() && letters < 3 && reference[letters] >= 'A' && reference[letters] <= 'Z')
+    {
+        column = column * 26 + (column_t)(reference[letters] - 'A' + 1);
+        letters++;
+    }
 
-                bool has_type = cell_node.attribute("t") != nullptr;
-                std::string type = cell_node.attribute("t").as_string();
+    if(!markup.has_reference || letters == 0 || reference.compare(letters, std::string::npos, row_string) != 0)
+    {
+        return 0;
+    }
 
-                bool has_style = cell_node.attribute("s") != nullptr;
-                std::string style = cell_node.attribute("s").as_string();
+    return column;
+}
 
-                bool has_formula = cell_node.child("f") != nullptr;
-                bool shared_formula = has_formula && cell_node.child("f").attribute("t") != nullptr && std::string(cell_node.child("f").attribute("t").as_string()) == "shared";
+// reads [first, last), the content of a sheetData element, with the tokenizer, which only
+// handles common markup; returns false if the sheet has to be read with the generic parser
+bool scan_rows(const char *first, const char *last, const row_context &context, std::vector<parsed_cell> &cells)
+{
+    detail::sheet_tokenizer tokenizer(first, last);
+    row_t row_index = 0;
+    std::string row_string;
+    int min_column = 0;
+    int max_column = 0;
+    int previous_column = 0;
+
+    while(true)
+    {
+        switch(tokenizer.next())
+        {
+        case detail::sheet_tokenizer::token::row:
+        {
+            const auto &row_reference = tokenizer.get_row_reference();
 
-                if(has_formula && !shared_formula && !ws.get_parent().get_data_only())
-                {
-                    std::string formula = cell_node.child("f").text().as_string();
-                    ws.get_cell(address).set_formula(formula);
-                }
+            // anything but a plain row number is left to pugixml's conversion
+            if(row_reference.size() > 9 || !std::all_of(row_reference.begin(), row_reference.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            {
+                return false;
+            }
 
-                if(has_type && type == "inlineStr") // inline string
-                {
-                    std::string inline_string = cell_node.child("is").child("t").text().as_string();
-                    ws.get_cell(address).set_value(inline_string);
-                }
-                else if(has_type && type == "s") // shared string
-                {
-                    auto shared_string_index = std::stoi(value_string);
-                    auto shared_string = string_table.at(shared_string_index);
-                    ws.get_cell(address).set_value(shared_string);
-                }
-                else if(has_type && type == "b") // boolean
-                {
-                    ws.get_cell(address).set_value(value(value_string != "0"));
-                }
-                else if(has_type && type == "str")
-                {
-                    ws.get_cell(address).set_value(value_string);
-                }
-                else if(has_style)
-                {
-                    auto number_format_id = number_format_ids.at(std::stoi(style));
-                    auto format = number_format::lookup_format(number_format_id);
-                    ws.get_cell(address).get_style().get_number_format().set_format_code(format);
-                    if(format == number_format::format::date_xlsx14)
-                    {
-                        auto base_date = ws.get_parent().get_properties().excel_base_date;
-                        auto converted = date::from_number(std::stoi(value_string), base_date);
-                        ws.get_cell(address).set_value(converted.to_number(calendar::windows_1900));
-                    }
-                    else
-                    {
-                        ws.get_cell(address).set_value(value(std::stod(value_string)));
-                    }
-                }
-                else if(has_value)
+            row_index = (row_t)std::strtoul(row_reference.c_str(), nullptr, 10);
+            row_string = std::to_string(row_index);
+            previous_column = 0;
+
+            // rows that aren't read are passed over up to their end tag
+            if(!context.selection.includes_row(row_index))
+            {
+                if(!tokenizer.skip_row())
                 {
-                    try
-                    {
-                        ws.get_cell(address).set_value(value(std::stod(value_string)));
-                    }
-                    catch(std::invalid_argument)
-                    {
-                        ws.get_cell(address).set_value(value_string);
-                    }
+                    return false;
                 }
+
+                min_column = 1;
+                max_column = 0;
+
+                break;
             }
+
+            // cells are only read from rows with spans
+            if(!tokenizer.has_spans() || !read_spans(tokenizer.get_spans(), min_column, max_column))
+            {
+                min_column = 1;
+                max_column = 0;
+            }
+            else if(min_column <= max_column && (min_column < 1 || (column_t)max_column > constants::MaxColumn))
+            {
+                return false;
+            }
+
+            break;
+        }
+        case detail::sheet_tokenizer::token::cell:
+        {
+            const auto &markup = tokenizer.get_cell();
+            auto column = (int)read_column(markup, row_string);
+
+            // the content of cells that aren't read is skipped by the next call to next
+            if(column < min_column || column > max_column || !context.selection.includes_column((column_t)column))
+            {
+                break;
+            }
+
+            // the generic reader visits cells in column order and takes the first of duplicates
+            if(column <= previous_column)
+            {
+                return false;
+            }
+
+            previous_column = column;
+
+            if(!tokenizer.read_cell_content())
+            {
+                return false;
+            }
+
+            read_cell(markup, (column_t)column, row_index, context, cells);
+
+            break;
+        }
+        case detail::sheet_tokenizer::token::end:
+            return true;
+        case detail::sheet_tokenizer::token::unsupported:
+            return false;
+        }
+    }
+}
+
+void apply_cells(worksheet ws, const std::vector<parsed_cell> &cells, const std::vector<std::string> &string_table, std::vector<std::pair<cell, std::size_t>> *shared_string_cells)
+{
+    for(auto current = cells.begin(); current != cells.end(); ++current)
+    {
+        const auto &parsed = *current;
+
+        // the cells of a row are parsed together, so its table is sized for all of them when
+        // the first is added
+        if(current == cells.begin() || (current - 1)->row != parsed.row)
+        {
+            auto row_end = std::find_if(current, cells.end(), [&](const parsed_cell &other) { return other.row != parsed.row; });
+            ws.reserve_cells(parsed.row - 1, static_cast<std::size_t>(row_end - current));
+        }
+
+        // parsed cells are numbered from 1 as in the markup, references from 0
+        auto cell = ws.get_cell(cell_reference(parsed.column - 1, parsed.row - 1));
+
+        if(parsed.has_formula)
+        {
+            cell.set_formula(parsed.formula);
+        }
+
+        if(parsed.has_style)
+        {
+            cell.set_style_id(parsed.style_id);
+        }
+
+        switch(parsed.kind)
+        {
+        case parsed_cell::value_kind::text:
+            cell.set_value(parsed.text);
+            break;
+        case parsed_cell::value_kind::number:
+            cell.set_value(value(parsed.number));
+            break;
+        case parsed_cell::value_kind::boolean:
+            cell.set_value(value(parsed.number != 0));
+            break;
+        case parsed_cell::value_kind::error:
+            cell.set_value(value::error(parsed.text));
+            break;
+        case parsed_cell::value_kind::shared_string:
+            if(shared_string_cells != nullptr)
+            {
+                shared_string_cells->push_back({ cell, parsed.shared_string_index });
+            }
+            else
+            {
+                cell.set_value(string_table.at(parsed.shared_string_index));
+            }
+            break;
+        case parsed_cell::value_kind::none:
+            break;
+        }
+    }
+}
+
+// sizes the sheet's table of rows for the height of its dimension, which is only a hint: a
+// missing or malformed dimension is ignored and the height is bounded by the rows selected and
+// the number of rows the markup could hold, so a wrong one leaves the table to grow as usual
+void reserve_rows(worksheet ws, const std::string &dimension, std::size_t max_rows, const projection &selection)
+{
+    if(dimension.empty() || max_rows == 0)
+    {
+        return;
+    }
+
+    row_t top = 0;
+    row_t bottom = 0;
+
+    try
+    {
+        range_reference reference(dimension);
+
+        // numbered from 1 as in the markup
+        top = std::min(reference.get_top_left().get_row_index(), reference.get_bottom_right().get_row_index()) + 1;
+        bottom = std::max(reference.get_top_left().get_row_index(), reference.get_bottom_right().get_row_index()) + 1;
+    }
+    catch(std::exception &)
+    {
+        return;
+    }
+
+    top = std::max(top, selection.first_row);
+    bottom = std::min(bottom, selection.last_row);
+
+    if(top > bottom)
+    {
+        return;
+    }
+
+    ws.reserve(std::min<std::size_t>(bottom - top + 1, max_rows));
+}
+
+row_context get_row_context(worksheet ws, const std::vector<std::size_t> &style_ids, const std::vector<detail::format_kind> &xf_kinds, const projection &selection)
+{
+    return { style_ids, xf_kinds, ws.get_parent().get_data_only(), ws.get_parent().get_properties().excel_base_date == calendar::mac_1904, selection };
+}
+
+// finds the content of sheetData, returning false if there isn't any
+bool find_rows(const std::string &xml_string, std::size_t &rows_begin, std::size_t &rows_end)
+{
+    auto start_tag = xml_string.find("<sheetData");
+
+    if(start_tag == std::string::npos)
+    {
+        return false;
+    }
+
+    auto start_tag_end = xml_string.find('>', start_tag);
+
+    if(start_tag_end == std::string::npos || xml_string[start_tag_end - 1] == '/')
+    {
+        return false;
+    }
+
+    rows_begin = start_tag_end + 1;
+    rows_end = xml_string.find("</sheetData>", rows_begin);
+
+    return rows_end != std::string::npos;
+}
+
+// the start of the first row element at or after position, or rows_end if there is none;
+// markup can't appear in text or attribute values, so a match is always a row start tag
+std::size_t find_row_start(const std::string &xml_string, std::size_t position, std::size_t rows_end)
+{
+    while((position = xml_string.find("<row", position)) < rows_end)
+    {
+        auto next = xml_string[position + 4];
+
+        if(next == ' ' || next == '>' || next == '/' || next == '\t' || next == '\r' || next == '\n')
+        {
+            return position;
         }
+
+        position += 4;
+    }
+
+    return rows_end;
+}
+
+// reads the rows in [rows_begin, rows_end) of xml_string, which must start and end at row boundaries
+std::vector<parsed_cell> read_rows(const std::string &xml_string, std::size_t rows_begin, std::size_t rows_end, const row_context &context)
+{
+    std::vector<parsed_cell> cells;
+
+    if(scan_rows(xml_string.data() + rows_begin, xml_string.data() + rows_end, context, cells))
+    {
+        return cells;
+    }
+
+    cells.clear();
+
+    auto rows_string = "<sheetData>" + xml_string.substr(rows_begin, rows_end - rows_begin) + "</sheetData>";
+    pugi::xml_document doc;
+    detail::parse_part(doc, rows_string, detail::xml_part_kind::worksheet);
+
+    for(auto row_node : doc.child("sheetData").children("row"))
+    {
+        read_row(row_node, context, cells);
+    }
+
+    return cells;
+}
+
+void read_rows_in_parallel(worksheet ws, const std::string &xml_string, std::size_t rows_begin, std::size_t rows_end, std::size_t chunk_count,
+    const row_context &context, const std::vector<std::string> &string_table, std::vector<std::pair<cell, std::size_t>> *shared_string_cells)
+{
+    std::vector<std::size_t> boundaries = { rows_begin };
+    auto rows_size = rows_end - rows_begin;
+
+    for(std::size_t i = 1; i < chunk_count; i++)
+    {
+        auto boundary = find_row_start(xml_string, std::max(rows_begin + rows_size * i / chunk_count, boundaries.back() + 1), rows_end);
+
+        if(boundary == rows_end)
+        {
+            break;
+        }
+
+        boundaries.push_back(boundary);
+    }
+
+    boundaries.push_back(rows_end);
+
+    // each chunk is parsed on its own thread and its cells are added to the sheet in order,
+    // the first while the rest are still being parsed
+    std::vector<std::future<std::vector<parsed_cell>>> chunks;
+
+    for(std::size_t i = 0; i + 1 < boundaries.size(); i++)
+    {
+        chunks.push_back(std::async(std::launch::async, read_rows, std::cref(xml_string), boundaries[i], boundaries[i + 1], std::cref(context)));
+    }
+
+    for(auto &chunk : chunks)
+    {
+        apply_cells(ws, chunk.get(), string_table, shared_string_cells);
+    }
+}
+
+} // namespace
+
+void read_worksheet_common(worksheet ws, const pugi::xml_node &root_node, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const std::vector<detail::format_kind> &xf_kinds,
+    std::vector<std::pair<cell, std::size_t>> *shared_string_cells = nullptr, const projection &selection = projection())
+{
+    auto dimension_node = root_node.child("dimension");
+    std::string dimension = dimension_node.attribute("ref").as_string();
+    auto sheet_data_node = root_node.child("sheetData");
+    auto merge_cells_node = root_node.child("mergeCells");
+
+    if(merge_cells_node != nullptr)
+    {
+        int count = merge_cells_node.attribute("count").as_int();
+        std::vector<range_reference> merged_ranges;
+
+        for(auto merge_cell_node : merge_cells_node.children("mergeCell"))
+        {
+            merged_ranges.push_back(merge_cell_node.attribute("ref").as_string());
+            count--;
+        }
+
+        if(count != 0)
+        {
+            throw std::runtime_error("mismatch between count and actual number of merged cells");
+        }
+
+        // added together so that they are indexed in one pass
+        ws.merge_cells(merged_ranges);
+    }
+
+    auto context = get_row_context(ws, style_ids, xf_kinds, selection);
+    std::vector<parsed_cell> cells;
+    std::size_t row_count = 0;
+
+    for(auto row_node = sheet_data_node.child("row"); row_node != nullptr; row_node = row_node.next_sibling("row"))
+    {
+        row_count++;
+    }
+
+    reserve_rows(ws, dimension, row_count, selection);
+
+    for(auto row_node : sheet_data_node.children("row"))
+    {
+        read_row(row_node, context, cells);
+        apply_cells(ws, cells, string_table, shared_string_cells);
+        cells.clear();
     }
 
     auto auto_filter_node = root_node.child("autoFilter");
@@ -357,35 +894,323 @@ void read_worksheet_common(worksheet ws, const pugi::xml_node &root_node, const
     }
 }
 
-void reader::fast_parse(worksheet ws, std::istream &xml_source, const std::vector<std::string> &shared_string, const std::vector<style> &/*style_table*/, std::size_t /*color_index*/)
+// xml_string may be overwritten, since the generic parser reads it in place
+void read_worksheet_string(worksheet ws, std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids,
+    const std::vector<detail::format_kind> &xf_kinds, std::vector<std::pair<cell, std::size_t>> *shared_string_cells, const projection &selection)
 {
+    std::size_t rows_begin = 0;
+    std::size_t rows_end = 0;
+
+    if(!find_rows(xml_string, rows_begin, rows_end))
+    {
+        pugi::xml_document doc;
+        detail::parse_part(doc, xml_string, detail::xml_part_kind::worksheet);
+        read_worksheet_common(ws, doc.child("worksheet"), string_table, style_ids, xf_kinds, shared_string_cells, selection);
+
+        return;
+    }
+
+    auto context = get_row_context(ws, style_ids, xf_kinds, selection);
+    std::size_t chunk_count = 0;
+
+    if(xml_string.size() >= ParallelParseThreshold)
+    {
+        chunk_count = std::min<std::size_t>(std::thread::hardware_concurrency(), (rows_end - rows_begin) / MinimumChunkSize);
+    }
+
+    std::vector<parsed_cell> cells;
+
+    // rows are scanned before anything is added to the worksheet so that the whole sheet can
+    // still be read with pugixml if they contain markup the tokenizer doesn't handle
+    if(chunk_count < 2 && !scan_rows(xml_string.data() + rows_begin, xml_string.data() + rows_end, context, cells))
+    {
+        pugi::xml_document doc;
+        detail::parse_part(doc, xml_string, detail::xml_part_kind::worksheet);
+        read_worksheet_common(ws, doc.child("worksheet"), string_table, style_ids, xf_kinds, shared_string_cells, selection);
+
+        return;
+    }
+
+    // the rest of the sheet is read as usual with its rows taken out
+    auto outline_string = xml_string.substr(0, rows_begin) + xml_string.substr(rows_end);
     pugi::xml_document doc;
-    doc.load(xml_source);
-    read_worksheet_common(ws, doc.child("worksheet"), shared_string, {});
+    detail::parse_part(doc, outline_string, detail::xml_part_kind::worksheet);
+    reserve_rows(ws, doc.child("worksheet").child("dimension").attribute("ref").as_string(), (rows_end - rows_begin) / MinimumRowSize, selection);
+    read_worksheet_common(ws, doc.child("worksheet"), string_table, style_ids, xf_kinds, shared_string_cells, selection);
+
+    if(chunk_count < 2)
+    {
+        apply_cells(ws, cells, string_table, shared_string_cells);
+    }
+    else
+    {
+        read_rows_in_parallel(ws, xml_string, rows_begin, rows_end, chunk_count, context, string_table, shared_string_cells);
+    }
 }
 
-void reader::read_worksheet(worksheet ws, const std::string &xml_string, const std::vector<std::string> &string_table, const std::vector<int> &number_format_ids)
+void reader::fast_parse(worksheet ws, std::istream &xml_source, const std::vector<std::string> &shared_string, const std::vector<style> &/*style_table*/, std::size_t /*color_index*/)
 {
+    // parse_part parses in place, so the stream is read into a buffer that outlives doc
+    std::string xml_string((std::istreambuf_iterator<char>(xml_source)), std::istreambuf_iterator<char>());
     pugi::xml_document doc;
-    doc.load(xml_string.c_str());
-    read_worksheet_common(ws, doc.child("worksheet"), string_table, number_format_ids);
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::worksheet);
+    read_worksheet_common(ws, doc.child("worksheet"), shared_string, {}, {});
+}
+
+// classify each xf once so that cells only need an indexed load to find date formats
+std::vector<detail::format_kind> get_xf_kinds(const detail::style_registry &registry, const std::vector<std::size_t> &style_ids)
+{
+    std::vector<detail::format_kind> xf_kinds;
+    xf_kinds.reserve(style_ids.size());
+
+    for(auto style_id : style_ids)
+    {
+        xf_kinds.push_back(registry.get_format_kind(style_id));
+    }
+
+    return xf_kinds;
+}
+
+void reader::read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids)
+{
+    read_worksheet_string(ws, xml_string, string_table, style_ids, get_xf_kinds(ws.get_parent().d_->styles_, style_ids), nullptr, projection());
+}
+
+void reader::read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::size_t> &style_ids, std::vector<std::pair<cell, std::size_t>> &shared_string_cells)
+{
+    read_worksheet_string(ws, xml_string, {}, style_ids, get_xf_kinds(ws.get_parent().d_->styles_, style_ids), &shared_string_cells, projection());
+}
+
+void reader::read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::size_t> &style_ids, std::vector<std::pair<cell, std::size_t>> &shared_string_cells, const load_options &options)
+{
+    read_worksheet_string(ws, xml_string, {}, style_ids, get_xf_kinds(ws.get_parent().d_->styles_, style_ids), &shared_string_cells, projection(options));
+}
+
+void reader::read_worksheet(worksheet ws, std::string xml_string, const std::vector<std::string> &string_table, const std::vector<std::size_t> &style_ids, const load_options &options)
+{
+    read_worksheet_string(ws, xml_string, string_table, style_ids, get_xf_kinds(ws.get_parent().d_->styles_, style_ids), nullptr, projection(options));
 }
 
 worksheet xlnt::reader::read_worksheet(std::istream &handle, xlnt::workbook &wb, const std::string &title, const std::vector<std::string> &string_table)
 {
     auto ws = wb.create_sheet();
     ws.set_title(title);
+    std::string xml_string((std::istreambuf_iterator<char>(handle)), std::istreambuf_iterator<char>());
     pugi::xml_document doc;
-    doc.load(handle);
-    read_worksheet_common(ws, doc.child("worksheet"), string_table, {});
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::worksheet);
+    read_worksheet_common(ws, doc.child("worksheet"), string_table, {}, {});
     return ws;
 }
 
-std::vector<std::string> reader::read_shared_string(const std::string &xml_string)
+namespace {
+
+color read_color(const pugi::xml_node &color_node, const color &default_color)
+{
+    if(color_node == nullptr)
+    {
+        return default_color;
+    }
+
+    if(color_node.attribute("rgb") != nullptr)
+    {
+        return color(color_node.attribute("rgb").as_string());
+    }
+
+    if(color_node.attribute("theme") != nullptr)
+    {
+        return color(color::type::theme, color_node.attribute("theme").as_int());
+    }
+
+    if(color_node.attribute("indexed") != nullptr)
+    {
+        return color(color_node.attribute("indexed").as_int());
+    }
+
+    return color(color::type::auto_, 0);
+}
+
+bool read_bool_element(const pugi::xml_node &node)
+{
+    return node != nullptr && (node.attribute("val") == nullptr || node.attribute("val").as_bool());
+}
+
+font read_font(const pugi::xml_node &font_node)
+{
+    font result;
+
+    result.size = font_node.child("sz").attribute("val").as_double(result.size);
+    result.name = font_node.child("name").attribute("val").as_string(result.name.c_str());
+    result.family = font_node.child("family").attribute("val").as_int(result.family);
+    result.scheme = font_node.child("scheme").attribute("val").as_string("");
+    result.bold = read_bool_element(font_node.child("b"));
+    result.italic = read_bool_element(font_node.child("i"));
+    result.strikethrough = read_bool_element(font_node.child("strike"));
+    result.color_ = read_color(font_node.child("color"), result.color_);
+
+    if(font_node.child("u") != nullptr)
+    {
+        result.underline_ = font::underline::single;
+        detail::from_name(font_node.child("u").attribute("val").as_string(), result.underline_);
+    }
+
+    std::string vertical_align = font_node.child("vertAlign").attribute("val").as_string();
+    result.superscript = vertical_align == "superscript";
+    result.subscript = vertical_align == "subscript";
+
+    return result;
+}
+
+fill read_fill(const pugi::xml_node &fill_node)
+{
+    fill result;
+
+    auto pattern_fill_node = fill_node.child("patternFill");
+
+    if(pattern_fill_node != nullptr)
+    {
+        detail::from_name(pattern_fill_node.attribute("patternType").as_string("none"), result.type_);
+        result.start_color = read_color(pattern_fill_node.child("fgColor"), result.start_color);
+        result.end_color = read_color(pattern_fill_node.child("bgColor"), result.end_color);
+    }
+
+    auto gradient_fill_node = fill_node.child("gradientFill");
+
+    if(gradient_fill_node != nullptr)
+    {
+        result.type_ = fill::type::gradient_linear;
+        detail::from_name(gradient_fill_node.attribute("type").as_string("linear"), result.type_);
+        result.rotation = gradient_fill_node.attribute("degree").as_int();
+    }
+
+    return result;
+}
+
+borders::border read_border(const pugi::xml_node &border_node)
+{
+    borders::border result;
+
+    detail::from_name(border_node.attribute("style").as_string("none"), result.style_);
+    result.color_ = read_color(border_node.child("color"), result.color_);
+
+    return result;
+}
+
+alignment read_alignment(const pugi::xml_node &alignment_node)
+{
+    alignment result;
+
+    detail::from_name(alignment_node.attribute("horizontal").as_string(), result.horizontal);
+    detail::from_name(alignment_node.attribute("vertical").as_string(), result.vertical);
+    result.text_rotation = alignment_node.attribute("textRotation").as_int();
+    result.wrap_text = alignment_node.attribute("wrapText").as_bool();
+    result.shrink_to_fit = alignment_node.attribute("shrinkToFit").as_bool();
+    result.indent = alignment_node.attribute("indent").as_int();
+
+    return result;
+}
+
+number_format read_number_format(int number_format_id, const std::unordered_map<int, std::string> &custom_formats)
+{
+    auto custom = custom_formats.find(number_format_id);
+    number_format result(number_format::lookup_format(number_format_id));
+
+    if(custom != custom_formats.end())
+    {
+        result.set_format_code(custom->second);
+    }
+    else if(result.get_format_code() == number_format::format::unknown && number_format::builtin_formats().count(number_format_id) != 0)
+    {
+        // builtin codes without an enumerator are kept as their code so they are written back with the same id
+        result.set_format_code(number_format::builtin_formats().at(number_format_id));
+    }
+
+    return result;
+}
+
+} // namespace
+
+std::vector<style> reader::read_styles(std::string xml_string)
+{
+    pugi::xml_document doc;
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::styles);
+    auto stylesheet_node = doc.child("styleSheet");
+
+    std::unordered_map<int, std::string> custom_formats;
+
+    for(auto num_fmt_node : stylesheet_node.child("numFmts").children("numFmt"))
+    {
+        custom_formats[num_fmt_node.attribute("numFmtId").as_int()] = num_fmt_node.attribute("formatCode").as_string();
+    }
+
+    std::vector<font> fonts;
+
+    for(auto font_node : stylesheet_node.child("fonts").children("font"))
+    {
+        fonts.push_back(read_font(font_node));
+    }
+
+    std::vector<fill> fills;
+
+    for(auto fill_node : stylesheet_node.child("fills").children("fill"))
+    {
+        fills.push_back(read_fill(fill_node));
+    }
+
+    std::vector<borders> borders_list;
+
+    for(auto border_node : stylesheet_node.child("borders").children("border"))
+    {
+        borders border_set;
+        border_set.left = read_border(border_node.child("left"));
+        border_set.right = read_border(border_node.child("right"));
+        border_set.top = read_border(border_node.child("top"));
+        border_set.bottom = read_border(border_node.child("bottom"));
+        border_set.diagonal = read_border(border_node.child("diagonal"));
+        borders_list.push_back(border_set);
+    }
+
+    std::vector<style> styles;
+
+    for(auto xf_node : stylesheet_node.child("cellXfs").children("xf"))
+    {
+        style xf_style;
+
+        xf_style.set_number_format(read_number_format(xf_node.attribute("numFmtId").as_int(), custom_formats));
+
+        auto font_id = xf_node.attribute("fontId").as_uint();
+        if(font_id < fonts.size())
+        {
+            xf_style.set_font(fonts[font_id]);
+        }
+
+        auto fill_id = xf_node.attribute("fillId").as_uint();
+        if(fill_id < fills.size())
+        {
+            xf_style.set_fill(fills[fill_id]);
+        }
+
+        auto border_id = xf_node.attribute("borderId").as_uint();
+        if(border_id < borders_list.size())
+        {
+            xf_style.set_borders(borders_list[border_id]);
+        }
+
+        if(xf_node.child("alignment") != nullptr)
+        {
+            xf_style.set_alignment(read_alignment(xf_node.child("alignment")));
+        }
+
+        styles.push_back(xf_style);
+    }
+
+    return styles;
+}
+
+std::vector<std::string> reader::read_shared_string(std::string xml_string)
 {
     std::vector<std::string> shared_strings;
     pugi::xml_document doc;
-    doc.load(xml_string.c_str());
+    detail::parse_part(doc, xml_string, detail::xml_part_kind::shared_strings);
     auto root_node = doc.child("sst");
     //int count = root_node.attribute("count").as_int();
     int unique_count = root_node.attribute("uniqueCount").as_int();
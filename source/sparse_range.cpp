@@ -0,0 +1,195 @@
+#include <algorithm>
+
+#include <xlnt/worksheet/sparse_range.hpp>
+#include <xlnt/cell/cell.hpp>
+
+#include "detail/worksheet_impl.hpp"
+
+namespace {
+
+// appends the row's cells from left to right inclusive in column order, walking the smaller of
+// the span and the row's cells
+void find_row_cells(xlnt::detail::cell_row &row, column_t left, column_t right, std::vector<xlnt::detail::cell_impl *> &cells)
+{
+    auto &table = row.cells_;
+
+    if(table.size() <= right - left)
+    {
+        auto first = cells.size();
+
+        for(auto &entry : table)
+        {
+            if(entry.first >= left && entry.first <= right)
+            {
+                cells.push_back(&entry.second);
+            }
+        }
+
+        std::sort(cells.begin() + static_cast<std::ptrdiff_t>(first), cells.end(), [](const xlnt::detail::cell_impl *a, const xlnt::detail::cell_impl *b)
+        {
+            return a->column_ < b->column_;
+        });
+    }
+    else
+    {
+        for(auto column = left; column <= right; column++)
+        {
+            auto match = table.find(column);
+
+            if(match != table.end())
+            {
+                cells.push_back(&match->second);
+            }
+        }
+    }
+}
+
+} // namespace
+
+namespace xlnt {
+
+sparse_range::sparse_range(worksheet ws, const range_reference &reference, major_order order)
+    : ws_(ws),
+    ref_(reference),
+    order_(order)
+{
+    auto top_left = reference.get_top_left();
+    auto bottom_right = reference.get_bottom_right();
+    left_ = std::min(top_left.get_column_index(), bottom_right.get_column_index());
+    right_ = std::max(top_left.get_column_index(), bottom_right.get_column_index());
+    auto top = std::min(top_left.get_row_index(), bottom_right.get_row_index());
+    auto bottom = std::max(top_left.get_row_index(), bottom_right.get_row_index());
+
+    rows_ = ws_.d_->find_rows(top, bottom);
+
+    if(order_ == major_order::row)
+    {
+        return;
+    }
+
+    for(auto row : rows_)
+    {
+        find_row_cells(ws_.d_->get_row(row), left_, right_, cells_);
+    }
+
+    cells_.erase(std::remove_if(cells_.begin(), cells_.end(), [](detail::cell_impl *d) { return cell(d).garbage_collectible(); }), cells_.end());
+
+    // the cells of each column are already in row order
+    std::stable_sort(cells_.begin(), cells_.end(), [](const detail::cell_impl *a, const detail::cell_impl *b)
+    {
+        return a->column_ < b->column_;
+    });
+}
+
+std::size_t sparse_range::size() const
+{
+    if(order_ == major_order::column)
+    {
+        return cells_.size();
+    }
+
+    std::size_t count = 0;
+
+    for(auto position = begin(); position != end(); ++position)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+bool sparse_range::empty() const
+{
+    return begin() == end();
+}
+
+range_reference sparse_range::get_reference() const
+{
+    return ref_;
+}
+
+major_order sparse_range::get_order() const
+{
+    return order_;
+}
+
+sparse_range::iterator sparse_range::begin() const
+{
+    return iterator(*this, false);
+}
+
+sparse_range::iterator sparse_range::end() const
+{
+    return iterator(*this, true);
+}
+
+sparse_range::iterator::iterator(const sparse_range &range, bool at_end)
+    : range_(&range),
+    next_(0),
+    row_position_(0),
+    current_(nullptr)
+{
+    if(!at_end)
+    {
+        advance();
+    }
+}
+
+void sparse_range::iterator::advance()
+{
+    if(range_->order_ == major_order::column)
+    {
+        current_ = next_ < range_->cells_.size() ? range_->cells_[next_++] : nullptr;
+        return;
+    }
+
+    while(true)
+    {
+        while(row_position_ < row_cells_.size())
+        {
+            auto candidate = row_cells_[row_position_++];
+
+            if(!cell(candidate).garbage_collectible())
+            {
+                current_ = candidate;
+                return;
+            }
+        }
+
+        if(next_ == range_->rows_.size())
+        {
+            current_ = nullptr;
+            return;
+        }
+
+        // the row is taken as get_cell takes it, so the cells handed out stay in this sheet
+        row_cells_.clear();
+        row_position_ = 0;
+        find_row_cells(range_->ws_.d_->get_row(range_->rows_[next_++]), range_->left_, range_->right_, row_cells_);
+    }
+}
+
+bool sparse_range::iterator::operator==(const iterator &rhs) const
+{
+    return range_ == rhs.range_ && current_ == rhs.current_;
+}
+
+sparse_range::iterator sparse_range::iterator::operator++(int)
+{
+    iterator old = *this;
+    ++*this;
+    return old;
+}
+
+sparse_range::iterator &sparse_range::iterator::operator++()
+{
+    advance();
+    return *this;
+}
+
+cell sparse_range::iterator::operator*() const
+{
+    return cell(current_);
+}
+
+} // namespace xlnt
@@ -1,19 +1,119 @@
+#include <functional>
+#include <string>
+
 #include <xlnt/styles/style.hpp>
 
+namespace {
+
+void hash_combine(std::size_t &seed, std::size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
 namespace xlnt {
 
-style::style(const style &rhs) : number_format_(rhs.number_format_), protection_(rhs.protection_)
+style::style(const style &rhs) : font_(rhs.font_), fill_(rhs.fill_), borders_(rhs.borders_), alignment_(rhs.alignment_), number_format_(rhs.number_format_), protection_(rhs.protection_)
+{
+}
+
+style &style::operator=(const style &rhs)
+{
+    font_ = rhs.font_;
+    fill_ = rhs.fill_;
+    borders_ = rhs.borders_;
+    alignment_ = rhs.alignment_;
+    number_format_ = rhs.number_format_;
+    protection_ = rhs.protection_;
+
+    return *this;
+}
+
+font style::get_font() const
+{
+    return font_;
+}
+
+void style::set_font(xlnt::font font)
+{
+    font_ = font;
+}
+
+fill style::get_fill() const
+{
+    return fill_;
+}
+
+void style::set_fill(xlnt::fill fill)
+{
+    fill_ = fill;
+}
+
+borders style::get_borders() const
+{
+    return borders_;
+}
+
+void style::set_borders(xlnt::borders borders)
+{
+    borders_ = borders;
+}
+
+alignment style::get_alignment() const
+{
+    return alignment_;
+}
+
+void style::set_alignment(xlnt::alignment alignment)
+{
+    alignment_ = alignment;
+}
+
+protection style::get_protection() const
 {
+    return protection_;
 }
 
 void style::set_protection(xlnt::protection protection)
 {
     protection_ = protection;
 }
-    
+
 void style::set_number_format(xlnt::number_format format)
 {
     number_format_ = format;
 }
-    
+
+std::size_t style::hash() const
+{
+    auto seed = number_format_.hash();
+
+    hash_combine(seed, std::hash<std::string>()(font_.name));
+    hash_combine(seed, std::hash<double>()(font_.size));
+    hash_combine(seed, (std::size_t)font_.bold);
+    hash_combine(seed, (std::size_t)font_.italic);
+    hash_combine(seed, (std::size_t)font_.color_.index);
+    hash_combine(seed, (std::size_t)borders_.top.style_);
+    hash_combine(seed, (std::size_t)borders_.bottom.style_);
+
+    hash_combine(seed, (std::size_t)fill_.type_);
+    hash_combine(seed, (std::size_t)fill_.start_color.index);
+    hash_combine(seed, (std::size_t)fill_.end_color.index);
+    hash_combine(seed, (std::size_t)alignment_.horizontal);
+    hash_combine(seed, (std::size_t)alignment_.vertical);
+    hash_combine(seed, (std::size_t)alignment_.wrap_text);
+
+    return seed;
+}
+
+bool style::operator==(const style &other) const
+{
+    return number_format_ == other.number_format_
+        && font_ == other.font_
+        && fill_ == other.fill_
+        && borders_ == other.borders_
+        && alignment_ == other.alignment_;
+}
+
 } // namespace xlnt
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sstream>
 #include <pugixml.hpp>
 
@@ -6,9 +7,166 @@
 #include <xlnt/worksheet/worksheet.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/drawing/drawing.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+#include "detail/cell_impl.hpp"
+#include "detail/style_names.hpp"
+#include "detail/worksheet_impl.hpp"
+#include "detail/workbook_impl.hpp"
 
 namespace xlnt {
 
+namespace {
+
+template<typename T>
+std::size_t find_or_add(std::vector<T> &items, const T &item)
+{
+    auto match = std::find(items.begin(), items.end(), item);
+
+    if(match != items.end())
+    {
+        return match - items.begin();
+    }
+
+    items.push_back(item);
+
+    return items.size() - 1;
+}
+
+void write_color(pugi::xml_node color_node, const color &c)
+{
+    switch(c.type_)
+    {
+    case color::type::rgb:
+        color_node.append_attribute("rgb").set_value(c.rgb.c_str());
+        break;
+    case color::type::theme:
+        color_node.append_attribute("theme").set_value(c.index);
+        break;
+    case color::type::indexed:
+        color_node.append_attribute("indexed").set_value(c.index);
+        break;
+    case color::type::auto_:
+        color_node.append_attribute("auto").set_value(1);
+        break;
+    }
+}
+
+void write_font(pugi::xml_node font_node, const font &f)
+{
+    if(f.bold)
+    {
+        font_node.append_child("b");
+    }
+
+    if(f.italic)
+    {
+        font_node.append_child("i");
+    }
+
+    if(f.strikethrough)
+    {
+        font_node.append_child("strike");
+    }
+
+    if(f.underline_ != font::underline::none)
+    {
+        font_node.append_child("u").append_attribute("val").set_value(detail::to_name(f.underline_).c_str());
+    }
+
+    if(f.superscript || f.subscript)
+    {
+        font_node.append_child("vertAlign").append_attribute("val").set_value(f.superscript ? "superscript" : "subscript");
+    }
+
+    font_node.append_child("sz").append_attribute("val").set_value(f.size);
+    write_color(font_node.append_child("color"), f.color_);
+    font_node.append_child("name").append_attribute("val").set_value(f.name.c_str());
+    font_node.append_child("family").append_attribute("val").set_value(f.family);
+
+    if(!f.scheme.empty())
+    {
+        font_node.append_child("scheme").append_attribute("val").set_value(f.scheme.c_str());
+    }
+}
+
+void write_fill(pugi::xml_node fill_node, const fill &f)
+{
+    if(f.type_ == fill::type::gradient_linear || f.type_ == fill::type::gradient_path)
+    {
+        auto gradient_fill_node = fill_node.append_child("gradientFill");
+        gradient_fill_node.append_attribute("type").set_value(detail::to_name(f.type_).c_str());
+
+        if(f.rotation != 0)
+        {
+            gradient_fill_node.append_attribute("degree").set_value(f.rotation);
+        }
+
+        return;
+    }
+
+    auto pattern_fill_node = fill_node.append_child("patternFill");
+    pattern_fill_node.append_attribute("patternType").set_value(detail::to_name(f.type_).c_str());
+
+    if(f.start_color != color::white)
+    {
+        write_color(pattern_fill_node.append_child("fgColor"), f.start_color);
+    }
+
+    if(f.end_color != color::black)
+    {
+        write_color(pattern_fill_node.append_child("bgColor"), f.end_color);
+    }
+}
+
+void write_border(pugi::xml_node border_node, const borders::border &b)
+{
+    if(b.style_ == borders::border::style::none)
+    {
+        return;
+    }
+
+    border_node.append_attribute("style").set_value(detail::to_name(b.style_).c_str());
+    write_color(border_node.append_child("color"), b.color_);
+}
+
+void write_alignment(pugi::xml_node alignment_node, const alignment &a)
+{
+    if(a.horizontal != alignment::horizontal_alignment::general)
+    {
+        alignment_node.append_attribute("horizontal").set_value(detail::to_name(a.horizontal).c_str());
+    }
+
+    if(a.vertical != alignment::vertical_alignment::bottom)
+    {
+        alignment_node.append_attribute("vertical").set_value(detail::to_name(a.vertical).c_str());
+    }
+
+    if(a.text_rotation != 0)
+    {
+        alignment_node.append_attribute("textRotation").set_value(a.text_rotation);
+    }
+
+    if(a.wrap_text)
+    {
+        alignment_node.append_attribute("wrapText").set_value(1);
+    }
+
+    if(a.shrink_to_fit)
+    {
+        alignment_node.append_attribute("shrinkToFit").set_value(1);
+    }
+
+    if(a.indent != 0)
+    {
+        alignment_node.append_attribute("indent").set_value(a.indent);
+    }
+}
+
+} // namespace
+
 style_writer::style_writer(xlnt::workbook &wb) : wb_(wb)
 {
   
@@ -16,42 +174,27 @@ style_writer::style_writer(xlnt::workbook &wb) : wb_(wb)
 
 std::unordered_map<std::size_t, std::string> style_writer::get_style_by_hash() const
 {
+    std::vector<style> distinct_styles;
+    std::vector<std::size_t> xf_ids;
+    wb_.d_->styles_.collect(distinct_styles, xf_ids);
+
     std::unordered_map<std::size_t, std::string> styles;
-    for(auto ws : wb_)
+
+    for(std::size_t id = 0; id < xf_ids.size(); id++)
     {
-        for(auto row : ws.rows())
-        {
-            for(auto cell : row)
-            {
-                if(cell.has_style())
-                {
-                    styles[1] = "style";
-                }
-            }
-        }
+        styles[id] = std::to_string(xf_ids[id]);
     }
+
     return styles;
 }
 
 std::vector<style> style_writer::get_styles() const
 {
-    std::vector<style> styles;
-    
-    for(auto ws : wb_)
-    {
-        for(auto row : ws.rows())
-        {
-            for(auto cell : row)
-            {
-                if(cell.has_style())
-                {
-                    styles.push_back(cell.get_style());
-                }
-            }
-        }
-    }
-    
-    return styles;
+    std::vector<style> distinct_styles;
+    std::vector<std::size_t> xf_ids;
+    wb_.d_->styles_.collect(distinct_styles, xf_ids);
+
+    return distinct_styles;
 }
     
 std::string style_writer::write_table() const
@@ -63,49 +206,94 @@ std::string style_writer::write_table() const
     style_sheet_node.append_attribute("mc:Ignorable").set_value("x14ac");
     style_sheet_node.append_attribute("xmlns:x14ac").set_value("http://schemas.microsoft.com/office/spreadsheetml/2009/9/ac");
 
-    std::vector<style> custom_styles;
-    for(auto style : get_styles())
+    auto styles = get_styles();
+
+    std::vector<int> number_format_ids;
+    std::vector<std::pair<int, std::string>> custom_formats;
+
+    for(const auto &current_style : styles)
     {
-        if((int)style.get_number_format().get_format_code() > 163)
+        auto format_string = current_style.get_number_format().get_format_string();
+
+        auto builtin = number_format::reversed_builtin_formats().find(format_string);
+
+        if(builtin != number_format::reversed_builtin_formats().end())
         {
-            custom_styles.push_back(style);
+            number_format_ids.push_back(builtin->second);
+            continue;
         }
+
+        auto custom = std::find_if(custom_formats.begin(), custom_formats.end(), [&](const std::pair<int, std::string> &p) { return p.second == format_string; });
+
+        if(custom == custom_formats.end())
+        {
+            custom_formats.push_back({164 + (int)custom_formats.size(), format_string});
+            custom = custom_formats.end() - 1;
+        }
+
+        number_format_ids.push_back(custom->first);
     }
 
-    if(!custom_styles.empty())
+    if(!custom_formats.empty())
     {
+        auto num_fmts_node = style_sheet_node.append_child("numFmts");
+        num_fmts_node.append_attribute("count").set_value((unsigned int)custom_formats.size());
 
+        for(const auto &custom_format : custom_formats)
+        {
+            auto num_fmt_node = num_fmts_node.append_child("numFmt");
+            num_fmt_node.append_attribute("numFmtId").set_value(custom_format.first);
+            num_fmt_node.append_attribute("formatCode").set_value(custom_format.second.c_str());
+        }
+    }
+
+    std::vector<font> fonts;
+    std::vector<fill> fills;
+    std::vector<borders> borders_list;
+
+    // Excel expects the first two fills to be none and gray125
+    fills.push_back(fill());
+    fills.push_back(fill());
+    fills.back().type_ = fill::type::pattern_gray125;
+
+    std::vector<std::size_t> font_ids, fill_ids, border_ids;
+
+    for(const auto &current_style : styles)
+    {
+        font_ids.push_back(find_or_add(fonts, current_style.get_font()));
+        fill_ids.push_back(find_or_add(fills, current_style.get_fill()));
+        border_ids.push_back(find_or_add(borders_list, current_style.get_borders()));
     }
 
     auto fonts_node = style_sheet_node.append_child("fonts");
-    fonts_node.append_attribute("count").set_value(1);
+    fonts_node.append_attribute("count").set_value((unsigned int)fonts.size());
     fonts_node.append_attribute("x14ac:knownFonts").set_value(1);
 
-    auto font_node = fonts_node.append_child("font");
-    auto size_node = font_node.append_child("sz");
-    size_node.append_attribute("val").set_value(11);
-    auto color_node = font_node.append_child("color");
-    color_node.append_attribute("theme").set_value(1);
-    auto name_node = font_node.append_child("name");
-    name_node.append_attribute("val").set_value("Calibri");
-    auto family_node = font_node.append_child("family");
-    family_node.append_attribute("val").set_value(2);
-    auto scheme_node = font_node.append_child("scheme");
-    scheme_node.append_attribute("val").set_value("minor");
+    for(const auto &current_font : fonts)
+    {
+        write_font(fonts_node.append_child("font"), current_font);
+    }
 
     auto fills_node = style_sheet_node.append_child("fills");
-    fills_node.append_attribute("count").set_value(2);
-    fills_node.append_child("fill").append_child("patternFill").append_attribute("patternType").set_value("none");
-    fills_node.append_child("fill").append_child("patternFill").append_attribute("patternType").set_value("gray125");
+    fills_node.append_attribute("count").set_value((unsigned int)fills.size());
+
+    for(const auto &current_fill : fills)
+    {
+        write_fill(fills_node.append_child("fill"), current_fill);
+    }
 
     auto borders_node = style_sheet_node.append_child("borders");
-    borders_node.append_attribute("count").set_value(1);
-    auto border_node = borders_node.append_child("border");
-    border_node.append_child("left");
-    border_node.append_child("right");
-    border_node.append_child("top");
-    border_node.append_child("bottom");
-    border_node.append_child("diagonal");
+    borders_node.append_attribute("count").set_value((unsigned int)borders_list.size());
+
+    for(const auto &current_borders : borders_list)
+    {
+        auto border_node = borders_node.append_child("border");
+        write_border(border_node.append_child("left"), current_borders.left);
+        write_border(border_node.append_child("right"), current_borders.right);
+        write_border(border_node.append_child("top"), current_borders.top);
+        write_border(border_node.append_child("bottom"), current_borders.bottom);
+        write_border(border_node.append_child("diagonal"), current_borders.diagonal);
+    }
 
     auto cell_style_xfs_node = style_sheet_node.append_child("cellStyleXfs");
     cell_style_xfs_node.append_attribute("count").set_value(1);
@@ -116,13 +304,43 @@ std::string style_writer::write_table() const
     xf_node.append_attribute("borderId").set_value(0);
 
     auto cell_xfs_node = style_sheet_node.append_child("cellXfs");
-    cell_xfs_node.append_attribute("count").set_value(1);
-    xf_node = cell_xfs_node.append_child("xf");
-    xf_node.append_attribute("numFmtId").set_value(0);
-    xf_node.append_attribute("fontId").set_value(0);
-    xf_node.append_attribute("fillId").set_value(0);
-    xf_node.append_attribute("borderId").set_value(0);
-    xf_node.append_attribute("xfId").set_value(0);
+    cell_xfs_node.append_attribute("count").set_value((unsigned int)styles.size());
+
+    for(std::size_t i = 0; i < styles.size(); i++)
+    {
+        xf_node = cell_xfs_node.append_child("xf");
+        xf_node.append_attribute("numFmtId").set_value(number_format_ids[i]);
+        xf_node.append_attribute("fontId").set_value((unsigned int)font_ids[i]);
+        xf_node.append_attribute("fillId").set_value((unsigned int)fill_ids[i]);
+        xf_node.append_attribute("borderId").set_value((unsigned int)border_ids[i]);
+        xf_node.append_attribute("xfId").set_value(0);
+
+        if(number_format_ids[i] != 0)
+        {
+            xf_node.append_attribute("applyNumberFormat").set_value(1);
+        }
+
+        if(font_ids[i] != 0)
+        {
+            xf_node.append_attribute("applyFont").set_value(1);
+        }
+
+        if(fill_ids[i] != 0)
+        {
+            xf_node.append_attribute("applyFill").set_value(1);
+        }
+
+        if(border_ids[i] != 0)
+        {
+            xf_node.append_attribute("applyBorder").set_value(1);
+        }
+
+        if(!(styles[i].get_alignment() == alignment()))
+        {
+            xf_node.append_attribute("applyAlignment").set_value(1);
+            write_alignment(xf_node.append_child("alignment"), styles[i].get_alignment());
+        }
+    }
 
     auto cell_styles_node = style_sheet_node.append_child("cellStyles");
     cell_styles_node.append_attribute("count").set_value(1);
@@ -3,6 +3,8 @@
 #include <xlnt/cell/value.hpp>
 #include <xlnt/common/datetime.hpp>
 
+#include "detail/number_codec.hpp"
+
 namespace xlnt {
 
 value value::error(const std::string &error_string)
@@ -16,9 +18,10 @@ value::value() : type_(type::null), numeric_value_(0)
 {
 }
 
-value::value(value &&v)
+value::value(value &&v) XLNT_NOEXCEPT : type_(v.type_), string_value_(std::move(v.string_value_)), numeric_value_(v.numeric_value_)
 {
-    swap(*this, v);
+    v.type_ = type::null;
+    v.numeric_value_ = 0;
 }
 
 value::value(const value &v)
@@ -40,7 +43,7 @@ value::value(double d) : type_(type::numeric), numeric_value_(d)
 {
 }
 
-value::value(int64_t i) : type_(type::numeric), numeric_value_((long double)i)
+value::value(long long int i) : type_(type::numeric), numeric_value_((long double)i)
 {
 }
 
@@ -118,13 +121,13 @@ int value::as() const
 }
 
 template<>
-int64_t value::as() const
+long long value::as() const
 {
     switch(type_)
     {
     case type::boolean:
     case type::numeric:
-        return (int64_t)numeric_value_;
+        return (long long)numeric_value_;
     case type::string:
         return std::stoi(string_value_);
     case type::error:
@@ -183,7 +186,11 @@ std::string value::to_string() const
     case type::boolean:
         return numeric_value_ != 0 ? "1" : "0";
     case type::numeric:
-        return std::to_string(numeric_value_);
+        if(is_integral())
+        {
+            return std::to_string((long long)numeric_value_);
+        }
+        return detail::format_number((double)numeric_value_);
     case type::string:
     case type::error:
         return string_value_;
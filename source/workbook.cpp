@@ -1,8 +1,10 @@
 #include <algorithm>
 #include <array>
 #include <fstream>
+#include <future>
 #include <set>
 #include <sstream>
+#include <unordered_set>
 #include <pugixml.hpp>
 
 #ifdef _WIN32
@@ -19,11 +21,104 @@
 #include <xlnt/writer/writer.hpp>
 #include <xlnt/common/zip_file.hpp>
 #include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/writer/style_writer.hpp>
 
 #include "detail/cell_impl.hpp"
+#include "detail/memory_counter.hpp"
+#include "detail/part_pipeline.hpp"
+#include "detail/static_parts.hpp"
 #include "detail/workbook_impl.hpp"
 #include "detail/worksheet_impl.hpp"
+#include "detail/xml_part.hpp"
+
+namespace {
+
+const std::string WorkbookContentType = "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml";
+
+std::string rels_part_name(const std::string &part_name)
+{
+    auto separator_index = part_name.find_last_of('/');
+
+    if(separator_index == std::string::npos)
+    {
+        return "_rels/" + part_name + ".rels";
+    }
+
+    return part_name.substr(0, separator_index) + "/_rels/" + part_name.substr(separator_index + 1) + ".rels";
+}
+
+// detached styles are only released when a cell is given another style, so those of cells
+// that have been removed since are recycled here before the style table is collected
+void release_unused_styles(xlnt::detail::workbook_impl &book)
+{
+    std::vector<bool> referenced(book.styles_.size(), false);
+
+    for(const auto &sheet : book.worksheets_)
+    {
+        for(const auto &row : *sheet->cell_map_)
+        {
+            for(const auto &cell : row.second->cells_)
+            {
+                referenced[cell.second.style_id_] = true;
+            }
+        }
+    }
+
+    book.styles_.release_unreferenced(referenced);
+}
+
+// the K of a title SheetK as create_sheet would write it, or 0 for any other title
+std::size_t default_sheet_number(const std::string &title)
+{
+    if(title.size() < 6 || title.size() > 15 || title.compare(0, 5, "Sheet") != 0 || title[5] == '0')
+    {
+        return 0;
+    }
+
+    std::size_t number = 0;
+
+    for(auto c : title.substr(5))
+    {
+        if(c < '0' || c > '9')
+        {
+            return 0;
+        }
+
+        number = number * 10 + static_cast<std::size_t>(c - '0');
+    }
+
+    return number;
+}
+
+std::size_t first_position(const std::unordered_multimap<std::string, std::size_t> &index, const std::string &key, std::size_t not_found)
+{
+    auto matches = index.equal_range(key);
+    auto first = not_found;
+
+    for(auto match = matches.first; match != matches.second; ++match)
+    {
+        first = std::min(first, match->second);
+    }
+
+    return first;
+}
+
+void erase_position(std::unordered_multimap<std::string, std::size_t> &index, const std::string &key, std::size_t position)
+{
+    auto matches = index.equal_range(key);
+
+    for(auto match = matches.first; match != matches.second; ++match)
+    {
+        if(match->second == position)
+        {
+            index.erase(match);
+            return;
+        }
+    }
+}
+
+} // namespace
 
 static std::string CreateTemporaryFilename()
 {
@@ -48,14 +143,161 @@ static std::string CreateTemporaryFilename()
 namespace xlnt {
 namespace detail {
 
-workbook_impl::workbook_impl() : active_sheet_index_(0), guess_types_(false), data_only_(false)
+workbook_impl::workbook_impl(memory_resource *resource) : active_sheet_index_(0), guess_types_(false), data_only_(false), source_style_count_(0), workbook_content_type_(WorkbookContentType), next_sheet_number_(1), resource_(resource)
 {
     
 }
 
+std::size_t workbook_impl::find_sheet(const std::string &title) const
+{
+    return first_position(sheet_titles_, title, worksheets_.size());
+}
+
+std::size_t workbook_impl::find_named_range(const std::string &name) const
+{
+    return first_position(named_range_sheets_, name, worksheets_.size());
+}
+
+std::size_t workbook_impl::find_position(const worksheet_impl *sheet, const std::string &title) const
+{
+    auto matches = sheet_titles_.equal_range(title);
+
+    for(auto match = matches.first; match != matches.second; ++match)
+    {
+        if(worksheets_[match->second].get() == sheet)
+        {
+            return match->second;
+        }
+    }
+
+    return worksheets_.size();
+}
+
+void workbook_impl::add_relationship(const relationship &rel)
+{
+    relationships_.push_back(rel);
+    relationship_ids_.emplace(rel.get_id(), relationships_.size() - 1);
+}
+
+void workbook_impl::add_sheet(std::unique_ptr<worksheet_impl> sheet)
+{
+    worksheets_.push_back(std::move(sheet));
+    index_sheet(worksheets_.size() - 1);
+}
+
+void workbook_impl::remove_sheet(std::size_t position)
+{
+    worksheets_.erase(worksheets_.begin() + static_cast<std::ptrdiff_t>(position));
+
+    // every later sheet has moved, so the indices are rebuilt
+    sheet_titles_.clear();
+    named_range_sheets_.clear();
+    next_sheet_number_ = 1;
+
+    for(std::size_t i = 0; i < worksheets_.size(); i++)
+    {
+        index_sheet(i);
+    }
+}
+
+void workbook_impl::swap_sheets(std::size_t first, std::size_t second)
+{
+    if(first == second)
+    {
+        return;
+    }
+
+    unindex_sheet(first);
+    unindex_sheet(second);
+    std::swap(worksheets_[first], worksheets_[second]);
+    index_sheet(first);
+    index_sheet(second);
+}
+
+void workbook_impl::retitle_sheet(const worksheet_impl *sheet, const std::string &old_title)
+{
+    auto position = find_position(sheet, old_title);
+
+    if(position == worksheets_.size())
+    {
+        return;
+    }
+
+    erase_position(sheet_titles_, old_title, position);
+    sheet_titles_.emplace(sheet->title_, position);
+
+    auto number = default_sheet_number(old_title);
+
+    if(number != 0)
+    {
+        next_sheet_number_ = std::min(next_sheet_number_, number);
+    }
+}
+
+void workbook_impl::add_named_range(const worksheet_impl *sheet, const std::string &name)
+{
+    auto position = find_position(sheet, sheet->title_);
+
+    if(position != worksheets_.size())
+    {
+        named_range_sheets_.emplace(name, position);
+    }
+}
+
+void workbook_impl::remove_named_range(const worksheet_impl *sheet, const std::string &name)
+{
+    auto position = find_position(sheet, sheet->title_);
+
+    if(position != worksheets_.size())
+    {
+        erase_position(named_range_sheets_, name, position);
+    }
+}
+
+void workbook_impl::clear_indices()
+{
+    sheet_titles_.clear();
+    named_range_sheets_.clear();
+    relationship_ids_.clear();
+    next_sheet_number_ = 1;
+}
+
+void workbook_impl::index_sheet(std::size_t position)
+{
+    const auto &sheet = *worksheets_[position];
+    sheet_titles_.emplace(sheet.title_, position);
+
+    for(const auto &named_range : sheet.named_ranges_)
+    {
+        named_range_sheets_.emplace(named_range.first, position);
+    }
+}
+
+void workbook_impl::unindex_sheet(std::size_t position)
+{
+    const auto &sheet = *worksheets_[position];
+    erase_position(sheet_titles_, sheet.title_, position);
+
+    for(const auto &named_range : sheet.named_ranges_)
+    {
+        erase_position(named_range_sheets_, named_range.first, position);
+    }
+
+    auto number = default_sheet_number(sheet.title_);
+
+    if(number != 0)
+    {
+        next_sheet_number_ = std::min(next_sheet_number_, number);
+    }
+}
+
 } // namespace detail
     
-workbook::workbook() : d_(new detail::workbook_impl())
+workbook::workbook() : workbook(default_resource())
+{
+}
+
+workbook::workbook(memory_resource *resource) : d_(new detail::workbook_impl(resource))
 {
     create_sheet("Sheet");
     create_relationship("rId2", "sharedStrings.xml", relationship::type::shared_strings);
@@ -131,57 +373,49 @@ bool workbook::const_iterator::operator==(const const_iterator &comparand) const
     
 worksheet workbook::get_sheet_by_name(const std::string &name)
 {
-    for(auto &impl : d_->worksheets_)
+    auto position = d_->find_sheet(name);
+
+    if(position == d_->worksheets_.size())
     {
-        if(impl.title_ == name)
-        {
-            return worksheet(&impl);
-        }
+        return worksheet();
     }
 
-    return worksheet();
+    return worksheet(d_->worksheets_[position].get());
 }
 
 worksheet workbook::get_sheet_by_index(std::size_t index)
 {
-    return worksheet(&d_->worksheets_[index]);
+    return worksheet(d_->worksheets_[index].get());
 }
     
 const worksheet workbook::get_sheet_by_index(std::size_t index) const
 {
-    return worksheet(&d_->worksheets_.at(index));
+    return worksheet(d_->worksheets_.at(index).get());
 }
 
 worksheet workbook::get_active_sheet()
 {
-    return worksheet(&d_->worksheets_[d_->active_sheet_index_]);
+    return worksheet(d_->worksheets_[d_->active_sheet_index_].get());
 }
 
 bool workbook::has_named_range(const std::string &name) const
 {
-    for(auto worksheet : *this)
-    {
-        if(worksheet.has_named_range(name))
-        {
-            return true;
-        }
-    }
-    return false;
+    return d_->find_named_range(name) != d_->worksheets_.size();
 }
 
 worksheet workbook::create_sheet()
 {   
-    std::string title = "Sheet1";
-    int index = 1;
+    auto number = d_->next_sheet_number_;
 
-    while(get_sheet_by_name(title) != nullptr)
+    while(d_->find_sheet("Sheet" + std::to_string(number)) != d_->worksheets_.size())
     {
-        title = "Sheet" + std::to_string(++index);
+        number++;
     }
 
-    d_->worksheets_.push_back(detail::worksheet_impl(this, title));
+    d_->next_sheet_number_ = number + 1;
+    d_->add_sheet(std::unique_ptr<detail::worksheet_impl>(new detail::worksheet_impl(this, "Sheet" + std::to_string(number), d_->resource_)));
     create_relationship("rId" + std::to_string(d_->relationships_.size() + 1), "worksheets/sheet" + std::to_string(d_->worksheets_.size()) + ".xml", relationship::type::worksheet);
-    return worksheet(&d_->worksheets_.back());
+    return worksheet(d_->worksheets_.back().get());
 }
 
 void workbook::add_sheet(xlnt::worksheet worksheet)
@@ -194,13 +428,66 @@ void workbook::add_sheet(xlnt::worksheet worksheet)
         }
     }
     
-    d_->worksheets_.emplace_back(*worksheet.d_);
+    std::unique_ptr<detail::worksheet_impl> copy(new detail::worksheet_impl(*worksheet.d_));
+    copy->parent_ = this;
+
+    // rows can only be shared with sheets allocating from the same resource, since either
+    // resource may go away first
+    bool copied_rows = false;
+
+    if(copy->resource_ != d_->resource_)
+    {
+        copy->resource_ = d_->resource_;
+        copy->copy_rows();
+        copied_rows = true;
+    }
+
+    // style ids are indices into the source workbook's registry, so the styles a sheet from
+    // another workbook uses are interned into this one's and its cells given the new ids
+    if(worksheet.d_->parent_ != this)
+    {
+        const auto &source_styles = worksheet.d_->parent_->d_->styles_;
+        std::unordered_map<std::size_t, std::size_t> style_ids;
+
+        for(const auto &row : *copy->cell_map_)
+        {
+            for(const auto &cell : row.second->cells_)
+            {
+                if(cell.second.style_id_ != 0 && style_ids.find(cell.second.style_id_) == style_ids.end())
+                {
+                    style_ids[cell.second.style_id_] = d_->styles_.intern(source_styles.get(cell.second.style_id_));
+                }
+            }
+        }
+
+        if(!style_ids.empty())
+        {
+            // the rows are still shared with the source sheet until they are copied
+            if(!copied_rows)
+            {
+                copy->copy_rows();
+            }
+
+            for(auto &row : *copy->cell_map_)
+            {
+                for(auto &cell : row.second->cells_)
+                {
+                    if(cell.second.style_id_ != 0)
+                    {
+                        cell.second.style_id_ = style_ids.at(cell.second.style_id_);
+                    }
+                }
+            }
+        }
+    }
+
+    d_->add_sheet(std::move(copy));
 }
 
 void workbook::add_sheet(xlnt::worksheet worksheet, std::size_t index)
 {
     add_sheet(worksheet);
-    std::swap(d_->worksheets_[index], d_->worksheets_.back());
+    d_->swap_sheets(index, d_->worksheets_.size() - 1);
 }
 
 int workbook::get_index(xlnt::worksheet worksheet)
@@ -230,32 +517,34 @@ void workbook::create_named_range(const std::string &name, worksheet range_owner
 
 void workbook::remove_named_range(const std::string &name)
 {
-    for(auto ws : *this)
+    auto position = d_->find_named_range(name);
+
+    if(position == d_->worksheets_.size())
     {
-        if(ws.has_named_range(name))
-        {
-            ws.remove_named_range(name);
-            return;
-        }
+        throw std::runtime_error("named range not found");
     }
-    
-    throw std::runtime_error("named range not found");
+
+    worksheet(d_->worksheets_[position].get()).remove_named_range(name);
 }
 
 range workbook::get_named_range(const std::string &name)
 {
-    for(auto ws : *this)
+    auto position = d_->find_named_range(name);
+
+    if(position == d_->worksheets_.size())
     {
-        if(ws.has_named_range(name))
-        {
-            return ws.get_named_range(name);
-        }
+        throw std::runtime_error("named range not found");
     }
-    
-    throw std::runtime_error("named range not found");
+
+    return worksheet(d_->worksheets_[position].get()).get_named_range(name);
 }
 
 bool workbook::load(const std::istream &stream)
+{
+    return load(stream, load_options());
+}
+
+bool workbook::load(const std::istream &stream, const load_options &options)
 {
     std::string temp_file = CreateTemporaryFilename();
     
@@ -263,12 +552,17 @@ bool workbook::load(const std::istream &stream)
     tmp.open(temp_file, std::ios::out | std::ios::binary);
     tmp << stream.rdbuf();
     tmp.close();
-    load(temp_file);
+    load(temp_file, options);
     std::remove(temp_file.c_str());
     return true;
 }
     
 bool workbook::load(const std::vector<unsigned char> &data)
+{
+    return load(data, load_options());
+}
+
+bool workbook::load(const std::vector<unsigned char> &data, const load_options &options)
 {
     std::string temp_file = CreateTemporaryFilename();
 
@@ -279,14 +573,20 @@ bool workbook::load(const std::vector<unsigned char> &data)
         tmp.put(c);
     }
     tmp.close();
-    load(temp_file);
+    load(temp_file, options);
     std::remove(temp_file.c_str());
     return true;
 }
 
 bool workbook::load(const std::string &filename)
 {
-    zip_file f;
+    return load(filename, load_options());
+}
+
+bool workbook::load(const std::string &filename, const load_options &options)
+{
+    auto archive = std::make_shared<zip_file>();
+    auto &f = *archive;
 
     try
     {
@@ -297,7 +597,9 @@ bool workbook::load(const std::string &filename)
         throw invalid_file_exception(filename);
     }
 
-    auto content_types = reader::read_content_types(f);
+    std::vector<std::pair<std::string, std::string>> default_types;
+    std::vector<std::pair<std::string, std::string>> content_types;
+    reader::read_content_types(f, default_types, content_types);
     auto type = reader::determine_document_type(content_types);
 
     if(type != "excel")
@@ -307,15 +609,12 @@ bool workbook::load(const std::string &filename)
     
     clear();
     
+    // worksheets are given relationships of their own by create_sheet
     auto workbook_relationships = reader::read_relationships(f, "xl/workbook.xml");
-
-    for(auto relationship : workbook_relationships)
-    {
-        create_relationship(relationship.get_id(), relationship.get_target_uri(), relationship.get_type());
-    }
     
+    auto workbook_xml = f.read("xl/workbook.xml");
     pugi::xml_document doc;
-    doc.load(f.read("xl/workbook.xml").c_str());
+    detail::parse_part(doc, workbook_xml, detail::xml_part_kind::workbook);
     
     auto root_node = doc.child("workbook");
     
@@ -323,35 +622,194 @@ bool workbook::load(const std::string &filename)
     get_properties().excel_base_date = (workbook_pr_node.attribute("date1904") != nullptr && workbook_pr_node.attribute("date1904").as_int() != 0) ? calendar::mac_1904 : calendar::windows_1900;
     
     auto sheets_node = root_node.child("sheets");
-    
-    std::vector<std::string> shared_strings;
+
+    std::vector<std::pair<std::string, std::string>> sheet_parts;
+    std::vector<std::string> skipped_parts;
+
+    for(auto sheet_node : sheets_node.children("sheet"))
+    {
+        std::string relation_id = sheet_node.attribute("r:id").as_string();
+        auto match = std::find_if(workbook_relationships.begin(), workbook_relationships.end(), [&](const relationship &r) { return r.get_id() == relation_id; });
+
+        if(match == workbook_relationships.end())
+        {
+            throw invalid_file_exception(filename);
+        }
+
+        // sheets that aren't selected are neither inflated nor parsed
+        if(!options.includes_sheet(sheet_node.attribute("name").as_string()))
+        {
+            skipped_parts.push_back(match->get_target_uri());
+            continue;
+        }
+
+        sheet_parts.push_back({ sheet_node.attribute("name").as_string(), match->get_target_uri() });
+    }
+
+    // the string table is read on a thread of its own while the sheets are, and cells holding
+    // shared strings are filled in once both are done
+    std::future<std::vector<std::string>> shared_strings_read;
+
     if(f.has_file("xl/sharedStrings.xml"))
     {
-        shared_strings = xlnt::reader::read_shared_string(f.read("xl/sharedStrings.xml"));
+        shared_strings_read = std::async(std::launch::async, [&f]() { return reader::read_shared_string(f.read("xl/sharedStrings.xml")); });
+    }
+
+    // the other parts are inflated on another thread in the order they're parsed here
+    auto has_styles = f.has_file("xl/styles.xml");
+    std::vector<std::string> part_names;
+
+    if(has_styles)
+    {
+        part_names.push_back("xl/styles.xml");
     }
 
-    std::vector<int> number_format_ids;
-    if(f.has_file("xl/styles.xml"))
+    for(const auto &sheet_part : sheet_parts)
     {
-        pugi::xml_document styles_doc;
-        styles_doc.load(f.read("xl/styles.xml").c_str());
-        auto stylesheet_node = styles_doc.child("styleSheet");
-        auto cell_xfs_node = stylesheet_node.child("cellXfs");
+        part_names.push_back(sheet_part.second);
+    }
+
+    detail::part_pipeline parts(f, part_names, 2);
 
-        for(auto xf_node : cell_xfs_node.children("xf"))
+    // cells refer to styles by xf index so each xf is interned once here
+    std::vector<std::size_t> style_ids;
+    if(has_styles)
+    {
+        for(const auto &xf_style : xlnt::reader::read_styles(parts.next()))
         {
-            number_format_ids.push_back(xf_node.attribute("numFmtId").as_int());
+            style_ids.push_back(d_->styles_.intern(xf_style));
         }
     }
+
+    auto style_count = d_->styles_.size();
+
+    // shared string cells are kept by address until they are filled in
+    std::vector<std::pair<cell, std::size_t>> shared_string_cells;
     
-    for(auto sheet_node : sheets_node.children("sheet"))
+    for(const auto &sheet_part : sheet_parts)
     {
-        std::string relation_id = sheet_node.attribute("r:id").as_string();
-        auto ws = create_sheet(sheet_node.attribute("name").as_string());
-        auto sheet_filename = get_relationship(relation_id).get_target_uri();
-        xlnt::reader::read_worksheet(ws, f.read(sheet_filename).c_str(), shared_strings, number_format_ids);
+        auto ws = create_sheet(sheet_part.first);
+        xlnt::reader::read_worksheet(ws, parts.next(), style_ids, shared_string_cells, options);
+        d_->worksheets_.back()->source_part_ = sheet_part.second;
+    }
+
+    std::vector<std::string> shared_strings;
+
+    if(shared_strings_read.valid())
+    {
+        shared_strings = shared_strings_read.get();
+    }
+
+    for(auto &shared_string_cell : shared_string_cells)
+    {
+        shared_string_cell.first.set_value(shared_strings.at(shared_string_cell.second));
+    }
+
+    // a projected sheet holds less than its part, so saving it writes what was loaded rather
+    // than copying the part from the archive
+    for(auto &sheet : d_->worksheets_)
+    {
+        sheet->modified_ = options.is_projected();
+    }
+
+    // everything the workbook doesn't model is kept as it is in the archive
+    std::unordered_set<std::string> modeled_parts = { "[Content_Types].xml", "_rels/.rels", "docProps/app.xml", "docProps/core.xml", "xl/workbook.xml", "xl/_rels/workbook.xml.rels" };
+
+    for(const auto &sheet : d_->worksheets_)
+    {
+        modeled_parts.insert(rels_part_name(sheet->source_part_));
+    }
+
+    for(const auto &skipped_part : skipped_parts)
+    {
+        modeled_parts.insert(rels_part_name(skipped_part));
     }
 
+    for(const auto &relationship : workbook_relationships)
+    {
+        switch(relationship.get_type())
+        {
+        case relationship::type::worksheet:
+        case relationship::type::chartsheet:
+        case relationship::type::styles:
+        case relationship::type::theme:
+        case relationship::type::shared_strings:
+            modeled_parts.insert(relationship.get_target_uri());
+            break;
+        default:
+            // the calculation chain would be stale once a formula changes and is rebuilt by Excel anyway
+            if(relationship.get_type_string() == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/calcChain")
+            {
+                modeled_parts.insert(relationship.get_target_uri());
+                break;
+            }
+
+            // targets were resolved against the package root and are written relative to xl/
+            auto target = relationship.get_target_uri();
+
+            if(target.substr(0, 3) == "xl/")
+            {
+                target = target.substr(3);
+            }
+            else if(target.substr(0, 2) != "..")
+            {
+                target = "/" + target;
+            }
+
+            d_->add_relationship(xlnt::relationship(relationship.get_type_string(), "rId" + std::to_string(d_->relationships_.size() + 1), target));
+            break;
+        }
+    }
+
+    if(f.has_file("_rels/.rels"))
+    {
+        for(const auto &relationship : reader::read_relationships(f, ""))
+        {
+            if(relationship.get_type() != relationship::type::office_document
+                && relationship.get_type() != relationship::type::core_properties
+                && relationship.get_type() != relationship::type::extended_properties)
+            {
+                d_->passthrough_root_relationships_.push_back(relationship);
+            }
+        }
+    }
+
+    std::unordered_set<std::string> passthrough_parts;
+
+    for(const auto &part_name : f.namelist())
+    {
+        if(!part_name.empty() && part_name.back() != '/' && modeled_parts.find(part_name) == modeled_parts.end())
+        {
+            d_->passthrough_parts_.push_back(part_name);
+            passthrough_parts.insert("/" + part_name);
+        }
+    }
+
+    for(const auto &default_type : default_types)
+    {
+        if(default_type.first != "xml" && default_type.first != "rels")
+        {
+            d_->passthrough_content_types_.push_back({ true, default_type.first, "", default_type.second });
+        }
+    }
+
+    for(const auto &override_type : content_types)
+    {
+        if(override_type.first == "/xl/workbook.xml")
+        {
+            d_->workbook_content_type_ = override_type.second;
+        }
+        else if(passthrough_parts.find(override_type.first) != passthrough_parts.end())
+        {
+            d_->passthrough_content_types_.push_back({ false, "", override_type.first, override_type.second });
+        }
+    }
+
+    d_->source_ = archive;
+    d_->source_shared_strings_ = std::make_shared<const std::vector<std::string>>(std::move(shared_strings));
+    d_->source_style_ids_ = style_ids;
+    d_->source_style_count_ = style_count;
+
     return true;
 }
 
@@ -367,33 +825,31 @@ bool workbook::get_guess_types() const
 
 void workbook::create_relationship(const std::string &id, const std::string &target, relationship::type type)
 {
-    d_->relationships_.push_back(relationship(type, id, target));
+    d_->add_relationship(relationship(type, id, target));
 }
 
 relationship workbook::get_relationship(const std::string &id) const
 {
-    for(auto &rel : d_->relationships_)
+    auto match = d_->relationship_ids_.find(id);
+
+    if(match == d_->relationship_ids_.end())
     {
-        if(rel.get_id() == id)
-        {
-            return rel;
-        }
+        throw std::runtime_error("");
     }
 
-    throw std::runtime_error("");
+    return d_->relationships_[match->second];
 }
     
 void workbook::remove_sheet(worksheet ws)
 {
-    auto match_iter = std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [=](detail::worksheet_impl &comp) { return worksheet(&comp) == ws; });
+    auto position = d_->find_position(ws.d_, ws.get_title());
 
-    if(match_iter == d_->worksheets_.end())
+    if(position == d_->worksheets_.size())
     {
         throw std::runtime_error("worksheet not owned by this workbook");
     }
 
-    
-    d_->worksheets_.erase(match_iter);
+    d_->remove_sheet(position);
 }
 
 worksheet workbook::create_sheet(std::size_t index)
@@ -402,10 +858,10 @@ worksheet workbook::create_sheet(std::size_t index)
     
     if(index != d_->worksheets_.size())
     {
-        std::swap(d_->worksheets_[index], d_->worksheets_.back());
+        d_->swap_sheets(index, d_->worksheets_.size() - 1);
     }
     
-    return worksheet(&d_->worksheets_[index]);
+    return worksheet(d_->worksheets_[index].get());
 }
 
 worksheet workbook::create_sheet(std::size_t index, const std::string &title)
@@ -431,11 +887,11 @@ worksheet workbook::create_sheet(const std::string &title)
     
     std::string unique_title = title;
     
-    if(std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [&](detail::worksheet_impl &ws) { return worksheet(&ws).get_title() == unique_title; }) != d_->worksheets_.end())
+    if(d_->find_sheet(unique_title) != d_->worksheets_.size())
     {
         std::size_t suffix = 1;
         
-        while(std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(), [&](detail::worksheet_impl &ws) { return worksheet(&ws).get_title() == unique_title; }) != d_->worksheets_.end())
+        while(d_->find_sheet(unique_title) != d_->worksheets_.size())
         {
             unique_title = title + std::to_string(suffix);
             suffix++;
@@ -487,16 +943,26 @@ worksheet workbook::operator[](const std::string &name)
 
 worksheet workbook::operator[](std::size_t index)
 {
-    return worksheet(&d_->worksheets_[index]);
+    return worksheet(d_->worksheets_[index].get());
 }
 
 void workbook::clear()
 {
     d_->worksheets_.clear();
     d_->relationships_.clear();
+    d_->clear_indices();
     d_->active_sheet_index_ = 0;
     d_->drawings_.clear();
     d_->properties_ = document_properties();
+    d_->styles_ = detail::style_registry();
+    d_->source_.reset();
+    d_->source_shared_strings_.reset();
+    d_->source_style_ids_.clear();
+    d_->source_style_count_ = 0;
+    d_->passthrough_parts_.clear();
+    d_->passthrough_content_types_.clear();
+    d_->passthrough_root_relationships_.clear();
+    d_->workbook_content_type_ = WorkbookContentType;
 }
 
 bool workbook::save(std::vector<unsigned char> &data)
@@ -518,34 +984,114 @@ bool workbook::save(const std::string &filename)
 {
     zip_file f;
 
+    release_unused_styles(*d_);
+
 	f.writestr("[Content_Types].xml", writer::write_content_types(*this));
     
     f.writestr("docProps/app.xml", writer::write_properties_app(*this));
     f.writestr("docProps/core.xml", writer::write_properties_core(get_properties()));
+
+    // Worksheets refer to shared strings and styles by index. While no style has been added
+    // since loading, the source archive's tables stay valid, so they are kept (with any new
+    // strings appended) and unmodified worksheets are copied from it without recompressing.
+    auto source = d_->source_.get();
+    bool keep_source_tables = source != nullptr && d_->styles_.size() == d_->source_style_count_;
+
+    // serials of a 1904 workbook are read relative to 1900 and workbook.xml is written without
+    // date1904, so its sheets are written again rather than copied with their 1904 serials
+    bool copy_source_sheets = keep_source_tables && get_properties().excel_base_date != calendar::mac_1904;
+
+    std::vector<std::string> shared_strings;
+    std::unordered_map<std::size_t, std::string> style_table;
     
-    std::set<std::string> shared_strings_set;
-    
-    for(auto ws : *this)
+    if(keep_source_tables)
+    {
+        shared_strings = *d_->source_shared_strings_;
+        std::unordered_set<std::string> known_strings(shared_strings.begin(), shared_strings.end());
+
+        for(const auto &sheet : d_->worksheets_)
+        {
+            const auto &ws = *sheet;
+
+            if(!ws.modified_ && !ws.source_part_.empty())
+            {
+                continue;
+            }
+
+            for(const auto &row : *ws.cell_map_)
+            {
+                for(const auto &cell : row.second->cells_)
+                {
+                    if(cell.second.value_.is(value::type::string) && known_strings.insert(cell.second.value_.get<std::string>()).second)
+                    {
+                        shared_strings.push_back(cell.second.value_.get<std::string>());
+                    }
+                }
+            }
+        }
+
+        if(shared_strings.size() == d_->source_shared_strings_->size() && source->has_file("xl/sharedStrings.xml"))
+        {
+            f.write_from(*source, "xl/sharedStrings.xml");
+        }
+        else
+        {
+            f.writestr("xl/sharedStrings.xml", writer::write_shared_strings(shared_strings));
+        }
+
+        for(std::size_t xf_index = 0; xf_index < d_->source_style_ids_.size(); xf_index++)
+        {
+            style_table.emplace(d_->source_style_ids_[xf_index], std::to_string(xf_index));
+        }
+
+        if(source->has_file("xl/styles.xml"))
+        {
+            f.write_from(*source, "xl/styles.xml");
+        }
+        else
+        {
+            f.writestr("xl/styles.xml", style_writer(*this).write_table());
+        }
+    }
+    else
     {
-        for(auto row : ws.rows())
+        std::set<std::string> shared_strings_set;
+        
+        for(auto ws : *this)
         {
-            for(auto cell : row)
+            for(auto row : ws.rows())
             {
-                if(cell.get_value().is(value::type::string))
+                for(auto cell : row)
                 {
-                    shared_strings_set.insert(cell.get_value().get<std::string>());
+                    if(cell.get_value().is(value::type::string))
+                    {
+                        shared_strings_set.insert(cell.get_value().get<std::string>());
+                    }
                 }
             }
         }
+        
+        shared_strings.assign(shared_strings_set.begin(), shared_strings_set.end());
+        f.writestr("xl/sharedStrings.xml", writer::write_shared_strings(shared_strings));
+
+        // collected once here rather than by each worksheet as it is written
+        style_writer styles(*this);
+        f.writestr("xl/styles.xml", styles.write_table());
+        style_table = styles.get_style_by_hash();
     }
     
-    std::vector<std::string> shared_strings(shared_strings_set.begin(), shared_strings_set.end());
-    f.writestr("xl/sharedStrings.xml", writer::write_shared_strings(shared_strings));
-    
-    f.writestr("xl/theme/theme1.xml", writer::write_theme());
-    f.writestr("xl/styles.xml", style_writer(*this).write_table());
-    
-    f.writestr("_rels/.rels", writer::write_root_rels());
+    const auto &theme = detail::get_deflated_theme();
+    f.write_deflated("xl/theme/theme1.xml", theme.data, theme.size, theme.crc);
+
+    if(d_->passthrough_root_relationships_.empty())
+    {
+        const auto &root_rels = detail::get_deflated_root_rels();
+        f.write_deflated("_rels/.rels", root_rels.data, root_rels.size, root_rels.crc);
+    }
+    else
+    {
+        f.writestr("_rels/.rels", writer::write_root_rels(*this));
+    }
     f.writestr("xl/_rels/workbook.xml.rels", writer::write_workbook_rels(*this));
 
     f.writestr("xl/workbook.xml", writer::write_workbook(*this));
@@ -557,11 +1103,31 @@ bool workbook::save(const std::string &filename)
             std::string sheet_index_string = relationship.get_target_uri().substr(16);
             std::size_t sheet_index = std::stoi(sheet_index_string.substr(0, sheet_index_string.find('.'))) - 1;
             std::string sheet_uri = "xl/" + relationship.get_target_uri();
+            const auto &sheet = *d_->worksheets_.at(sheet_index);
+
+            // the sheet's relationships are kept for the drawings, controls and so on it refers to
+            if(source != nullptr && sheet.source_part_ == sheet_uri && source->has_file(rels_part_name(sheet_uri)))
+            {
+                f.write_from(*source, rels_part_name(sheet_uri));
+            }
+
+            if(copy_source_sheets && !sheet.modified_ && sheet.source_part_ == sheet_uri)
+            {
+                f.write_from(*source, sheet_uri);
+                continue;
+            }
+
             auto ws = get_sheet_by_index(sheet_index);
-            f.writestr(sheet_uri, writer::write_worksheet(ws, shared_strings));
+            // columns are only given the styles of their cells when saving with the source's table
+            f.writestr(sheet_uri, writer::write_worksheet(ws, shared_strings, style_table, keep_source_tables));
         }
     }
 
+    for(const auto &part_name : d_->passthrough_parts_)
+    {
+        f.write_from(*source, part_name);
+    }
+
     f.save(filename);
 
     return true;
@@ -581,13 +1147,23 @@ std::vector<relationship> xlnt::workbook::get_relationships() const
 {
 	return d_->relationships_;
 }
+
+memory_resource *workbook::get_memory_resource() const
+{
+    return d_->resource_;
+}
+
+memory_report workbook::get_memory_usage() const
+{
+    return detail::memory_counter::count(*d_);
+}
  
 std::vector<content_type> xlnt::workbook::get_content_types() const
 {
 	std::vector<content_type> content_types;
 	content_types.push_back({ true, "xml", "", "application/xml" });
 	content_types.push_back({ true, "rels", "", "application/vnd.openxmlformats-package.relationships+xml" });
-	content_types.push_back({ false, "", "/xl/workbook.xml", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml" });
+	content_types.push_back({ false, "", "/xl/workbook.xml", d_->workbook_content_type_ });
 	for(std::size_t i = 0; i < get_sheet_names().size(); i++)
 	{
 	    content_types.push_back({false, "", "/xl/worksheets/sheet" + std::to_string(i + 1) + ".xml", "application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml"});
@@ -597,6 +1173,7 @@ std::vector<content_type> xlnt::workbook::get_content_types() const
 	content_types.push_back({false, "", "/xl/sharedStrings.xml", "application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml"});
 	content_types.push_back({false, "", "/docProps/core.xml", "application/vnd.openxmlformats-package.core-properties+xml"});
 	content_types.push_back({false, "", "/docProps/app.xml", "application/vnd.openxmlformats-officedocument.extended-properties+xml"});
+	content_types.insert(content_types.end(), d_->passthrough_content_types_.begin(), d_->passthrough_content_types_.end());
 	return content_types;
 }
 
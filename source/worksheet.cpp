@@ -8,11 +8,42 @@
 #include <xlnt/worksheet/range_reference.hpp>
 #include <xlnt/common/relationship.hpp>
 #include <xlnt/workbook/workbook.hpp>
+#include <xlnt/workbook/document_properties.hpp>
 #include <xlnt/common/exceptions.hpp>
+#include <xlnt/drawing/drawing.hpp>
 
+#include "detail/memory_counter.hpp"
+#include "detail/string_classifier.hpp"
+#include "detail/workbook_impl.hpp"
 #include "detail/worksheet_impl.hpp"
 
 namespace xlnt {
+namespace {
+
+// only the top left cell of a merged range keeps its value
+void clear_merged_cells(worksheet ws, const detail::worksheet_impl &d, const range_reference &reference)
+{
+    for(auto cell_reference : d.find_cells(reference, major_order::row))
+    {
+        if(cell_reference == reference.get_top_left())
+        {
+            continue;
+        }
+
+        auto cell = ws.get_cell(cell_reference);
+
+        if(cell.get_value().is(value::type::string))
+        {
+            cell.set_value(value(""));
+        }
+        else
+        {
+            cell.set_value(value::null());
+        }
+    }
+}
+
+} // namespace
 
 worksheet::worksheet() : d_(nullptr)
 {
@@ -53,7 +84,13 @@ std::string worksheet::unique_sheet_name(const std::string &value) const
 
 void worksheet::create_named_range(const std::string &name, const range_reference &reference)
 {
+    auto is_new = d_->named_ranges_.find(name) == d_->named_ranges_.end();
     d_->named_ranges_[name] = reference;
+
+    if(is_new)
+    {
+        d_->parent_->d_->add_named_range(d_, name);
+    }
 }
 
 range worksheet::operator()(const xlnt::cell_reference &top_left, const xlnt::cell_reference &bottom_right)
@@ -68,16 +105,18 @@ cell worksheet::operator[](const cell_reference &ref)
 
 std::vector<range_reference> worksheet::get_merged_ranges() const
 {
-    return d_->merged_cells_;
+    return d_->merged_cells_.get_ranges();
 }
 
 margins &worksheet::get_page_margins()
 {
+    d_->modified_ = true;
     return d_->page_margins_;
 }
 
 void worksheet::auto_filter(const range_reference &reference)
 {
+    d_->modified_ = true;
     d_->auto_filter_ = reference;
 }
 
@@ -98,11 +137,13 @@ bool worksheet::has_auto_filter() const
 
 void worksheet::unset_auto_filter()
 {
+    d_->modified_ = true;
     d_->auto_filter_ = range_reference(0, 0, 0, 0);
 }
 
 page_setup &worksheet::get_page_setup()
 {
+    d_->modified_ = true;
     return d_->page_setup_;
 }
 
@@ -118,28 +159,30 @@ workbook &worksheet::get_parent() const
 
 void worksheet::garbage_collect()
 {
-    auto cell_map_iter = d_->cell_map_.begin();
+    auto &rows = d_->get_rows();
+    auto cell_map_iter = rows.begin();
 
-    while(cell_map_iter != d_->cell_map_.end())
+    while(cell_map_iter != rows.end())
     {
-        auto cell_iter = cell_map_iter->second.begin();
+        auto &row = d_->get_row(cell_map_iter->first);
+        auto cell_iter = row.cells_.begin();
 
-        while(cell_iter != cell_map_iter->second.end())
+        while(cell_iter != row.cells_.end())
         {
             cell current_cell(&cell_iter->second);
 
             if(current_cell.garbage_collectible())
             {
-                cell_iter = cell_map_iter->second.erase(cell_iter);
+                cell_iter = row.cells_.erase(cell_iter);
                 continue;
             }
 
             cell_iter++;
         }
 
-        if(cell_map_iter->second.empty())
+        if(row.cells_.empty())
         {
-            cell_map_iter = d_->cell_map_.erase(cell_map_iter);
+            cell_map_iter = rows.erase(cell_map_iter);
             continue;
         }
 
@@ -150,9 +193,9 @@ void worksheet::garbage_collect()
 std::list<cell> worksheet::get_cell_collection()
 {
     std::list<cell> cells;
-    for(auto &c : d_->cell_map_)
+    for(auto &c : d_->get_rows())
     {
-        for(auto &d : c.second)
+        for(auto &d : d_->get_row(c.first).cells_)
         {
             cells.push_back(cell(&d.second));
         }
@@ -171,7 +214,9 @@ std::string worksheet::get_title() const
 
 void worksheet::set_title(const std::string &title)
 {
+    auto old_title = d_->title_;
     d_->title_ = title;
+    d_->parent_->d_->retitle_sheet(d_, old_title);
 }
 
 cell_reference worksheet::get_frozen_panes() const
@@ -181,16 +226,19 @@ cell_reference worksheet::get_frozen_panes() const
 
 void worksheet::freeze_panes(xlnt::cell top_left_cell)
 {
+    d_->modified_ = true;
     d_->freeze_panes_ = top_left_cell.get_reference();
 }
 
 void worksheet::freeze_panes(const std::string &top_left_coordinate)
 {
+    d_->modified_ = true;
     d_->freeze_panes_ = cell_reference(top_left_coordinate);
 }
 
 void worksheet::unfreeze_panes()
 {
+    d_->modified_ = true;
     d_->freeze_panes_ = cell_reference("A1");
 }
 
@@ -206,28 +254,28 @@ const std::unordered_map<row_t, double> &worksheet::get_row_dimensions() const
 
 cell worksheet::get_cell(const cell_reference &reference)
 {
-    if(d_->cell_map_.find(reference.get_row_index()) == d_->cell_map_.end())
-    {
-        d_->cell_map_[reference.get_row_index()] = std::unordered_map<column_t, detail::cell_impl>();
-    }
-    
-    auto &row = d_->cell_map_[reference.get_row_index()];
+    auto &row = d_->get_row(reference.get_row_index()).cells_;
+    auto match = row.find(reference.get_column_index());
     
-    if(row.find(reference.get_column_index()) == row.end())
+    if(match == row.end())
     {
-        row[reference.get_column_index()] = detail::cell_impl(d_, reference.get_column_index(), reference.get_row_index());
+        match = row.emplace(reference.get_column_index(), detail::cell_impl(d_, reference.get_column_index(), reference.get_row_index())).first;
     }
     
-    return cell(&row[reference.get_column_index()]);
+    return cell(&match->second);
 }
 
 const cell worksheet::get_cell(const cell_reference &reference) const
 {
-    return cell(&d_->cell_map_.at(reference.get_row_index()).at(reference.get_column_index()));
+    // throws for a missing cell before the row is taken from a sheet it may be shared with
+    d_->cell_map_->at(reference.get_row_index())->cells_.at(reference.get_column_index());
+
+    return cell(&d_->get_row(reference.get_row_index()).cells_.at(reference.get_column_index()));
 }
 
 row_properties &worksheet::get_row_properties(row_t row)
 {
+    d_->modified_ = true;
     return d_->row_properties_[row];
 }
 
@@ -248,16 +296,16 @@ range worksheet::get_named_range(const std::string &name)
 
 column_t worksheet::get_lowest_column() const
 {
-    if(d_->cell_map_.empty())
+    if(d_->cell_map_->empty())
     {
         return 1;
     }
     
     column_t lowest = std::numeric_limits<column_t>::max();
     
-    for(auto &row : d_->cell_map_)
+    for(auto &row : *d_->cell_map_)
     {
-        for(auto &c : row.second)
+        for(auto &c : row.second->cells_)
         {
             lowest = std::min(lowest, (column_t)c.first);
         }
@@ -268,14 +316,14 @@ column_t worksheet::get_lowest_column() const
 
 row_t worksheet::get_lowest_row() const
 {
-    if(d_->cell_map_.empty())
+    if(d_->cell_map_->empty())
     {
         return 1;
     }
     
     row_t lowest = std::numeric_limits<row_t>::max();
     
-    for(auto &row : d_->cell_map_)
+    for(auto &row : *d_->cell_map_)
     {
         lowest = std::min(lowest, (row_t)row.first);
     }
@@ -287,7 +335,7 @@ row_t worksheet::get_highest_row() const
 {
     row_t highest = 0;
     
-    for(auto &row : d_->cell_map_)
+    for(auto &row : *d_->cell_map_)
     {
         highest = std::max(highest, (row_t)row.first);
     }
@@ -299,9 +347,9 @@ column_t worksheet::get_highest_column() const
 {
     column_t highest = 0;
     
-    for(auto &row : d_->cell_map_)
+    for(auto &row : *d_->cell_map_)
     {
-        for(auto &c : row.second)
+        for(auto &c : row.second->cells_)
         {
             highest = std::max(highest, (column_t)c.first);
         }
@@ -345,57 +393,64 @@ relationship worksheet::create_relationship(relationship::type type, const std::
 
 void worksheet::merge_cells(const range_reference &reference)
 {
-    d_->merged_cells_.push_back(reference);
-    bool first = true;
-
-    for(auto row : get_range(reference))
-    {
-        for(auto cell : row)
-        {
-            cell.set_merged(true);
+    d_->modified_ = true;
+    d_->merged_cells_.insert(reference);
+    clear_merged_cells(*this, *d_, reference);
+}
 
-            if(!first)
-            {
-                if(cell.get_value().is(value::type::string))
-                {
-                    cell.set_value(value(""));
-                }
-                else
-                {
-                    cell.set_value(value::null());
-                }
-            }
+void worksheet::merge_cells(const std::vector<range_reference> &references)
+{
+    d_->modified_ = true;
+    d_->merged_cells_.insert(references);
 
-            first = false;
-        }
+    for(const auto &reference : references)
+    {
+        clear_merged_cells(*this, *d_, reference);
     }
 }
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
-    auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
+    d_->modified_ = true;
     
-    if(match == d_->merged_cells_.end())
+    if(!d_->merged_cells_.erase(reference))
     {
         throw std::runtime_error("cells not merged");
     }
     
-    d_->merged_cells_.erase(match);
-    
-    for(auto row : get_range(reference))
+    for(auto cell_reference : d_->find_cells(reference, major_order::row))
     {
-        for(auto cell : row)
-        {
-            cell.set_merged(false);
-        }
+        get_cell(cell_reference).set_merged(false);
     }
 }
 
+std::vector<range_reference> worksheet::get_merged_ranges(const range_reference &overlapping) const
+{
+    return d_->merged_cells_.find_overlapping(overlapping);
+}
+
+bool worksheet::has_merged_range(const cell_reference &reference) const
+{
+    return d_->merged_cells_.find(reference) != nullptr;
+}
+
+range_reference worksheet::get_merged_range(const cell_reference &reference) const
+{
+    auto match = d_->merged_cells_.find(reference);
+
+    if(match == nullptr)
+    {
+        throw std::runtime_error("cell not merged");
+    }
+
+    return *match;
+}
+
 void worksheet::append(const std::vector<std::string> &cells)
 {
     int row = get_highest_row();
     
-    if(d_->cell_map_.size() == 0)
+    if(d_->cell_map_->size() == 0)
     {
         row--;
     }
@@ -412,7 +467,7 @@ void worksheet::append(const std::vector<int> &cells)
 {
     int row = get_highest_row();
     
-    if(d_->cell_map_.size() == 0)
+    if(d_->cell_map_->size() == 0)
     {
         row--;
     }
@@ -429,7 +484,7 @@ void worksheet::append(const std::vector<date> &cells)
 {
     int row = get_highest_row();
     
-    if(d_->cell_map_.size() == 0)
+    if(d_->cell_map_->size() == 0)
     {
         row--;
     }
@@ -446,7 +501,7 @@ void worksheet::append(const std::unordered_map<std::string, std::string> &cells
 {
 	int row = get_highest_row() - 1;
 
-    if(d_->cell_map_.size() != 0)
+    if(d_->cell_map_->size() != 0)
     {
         row++;
     }
@@ -461,7 +516,7 @@ void worksheet::append(const std::unordered_map<int, std::string> &cells)
 {
     int row = get_highest_row() - 1;
 
-    if(d_->cell_map_.size() != 0)
+    if(d_->cell_map_->size() != 0)
     {
         row++;
     }
@@ -472,6 +527,30 @@ void worksheet::append(const std::unordered_map<int, std::string> &cells)
     }
 }
 
+void worksheet::set_column_values(const cell_reference &first_cell, const std::vector<std::string> &values)
+{
+    auto column = first_cell.get_column_index();
+    auto row = first_cell.get_row_index();
+
+    if(!get_parent().get_guess_types())
+    {
+        for(const auto &value_string : values)
+        {
+            get_cell(cell_reference(column, row++)).set_value(value_string);
+        }
+
+        return;
+    }
+
+    std::vector<detail::string_classification> classifications;
+    detail::classify_strings(values, classifications);
+
+    for(std::size_t i = 0; i < values.size(); i++)
+    {
+        get_cell(cell_reference(column, row++)).set_classified_value(values[i], classifications[i]);
+    }
+}
+
 xlnt::range worksheet::rows() const
 {
     return get_range(calculate_dimension());
@@ -540,11 +619,17 @@ void worksheet::remove_named_range(const std::string &name)
     }
 
     d_->named_ranges_.erase(name);
+    d_->parent_->d_->remove_named_range(d_, name);
 }
 
 void worksheet::reserve(std::size_t n)
 {
-    d_->cell_map_.reserve(n);
+    d_->get_rows().reserve(n);
+}
+
+void worksheet::reserve_cells(row_t row, std::size_t n)
+{
+    d_->get_row(row).cells_.reserve(n);
 }
     
 void worksheet::increment_comments()
@@ -562,8 +647,15 @@ std::size_t worksheet::get_comment_count() const
     return d_->comment_count_;
 }
 
+memory_usage worksheet::get_memory_usage() const
+{
+    std::unordered_set<const void *> counted;
+    return detail::memory_counter::count(*d_, counted);
+}
+
 header_footer &worksheet::get_header_footer()
 {
+    d_->modified_ = true;
     return d_->header_footer_;
 }
 
@@ -1,12 +1,14 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <map>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 
 #include <pugixml.hpp>
 
+#include <xlnt/writer/style_writer.hpp>
 #include <xlnt/writer/writer.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/value.hpp>
@@ -16,8 +18,13 @@
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/common/relationship.hpp>
 #include <xlnt/workbook/document_properties.hpp>
+#include <xlnt/drawing/drawing.hpp>
 
 #include "constants.hpp"
+#include "detail/cell_impl.hpp"
+#include "detail/number_codec.hpp"
+#include "detail/worksheet_impl.hpp"
+#include "detail/workbook_impl.hpp"
 
 namespace xlnt {
 
@@ -201,7 +208,12 @@ std::string writer::write_workbook(const workbook &wb)
     return ss.str();
 }
 
-std::string writer::write_worksheet(worksheet ws, const std::vector<std::string> &string_table, const std::unordered_map<std::size_t, std::string> &style_id_by_hash)
+std::string writer::write_worksheet(worksheet ws, const std::vector<std::string> &string_table, const std::unordered_map<std::size_t, std::string> &style_table)
+{
+    return write_worksheet(ws, string_table, style_table, !style_table.empty());
+}
+
+std::string writer::write_worksheet(worksheet ws, const std::vector<std::string> &string_table, const std::unordered_map<std::size_t, std::string> &style_table, bool column_styles)
 {
     ws.get_cell("A1");
 
@@ -280,32 +292,18 @@ std::string writer::write_worksheet(worksheet ws, const std::vector<std::string>
     sheet_format_pr_node.append_attribute("baseColWidth").set_value(10);
     sheet_format_pr_node.append_attribute("defaultRowHeight").set_value(15);
     
-    std::vector<int> styled_columns;
-    
-    if(!style_id_by_hash.empty())
+    // styles.xml is written from the workbook's style registry so cells can be given their
+    // xf index as they are written, without a separate pass over the sheet
+    std::unordered_map<std::size_t, std::string> workbook_style_table;
+
+    if(style_table.empty())
     {
-        for(auto row : ws.rows())
-        {
-            for(auto cell : row)
-            {
-                if(cell.has_style())
-                {
-                    styled_columns.push_back(xlnt::cell_reference::column_index_from_string(cell.get_column()));
-                }
-            }
-        }
-        
-        auto cols_node = root_node.append_child("cols");
-        std::sort(styled_columns.begin(), styled_columns.end());
-        for(auto column : styled_columns)
-        {
-            auto col_node = cols_node.append_child("col");
-            col_node.append_attribute("min").set_value(column);
-            col_node.append_attribute("max").set_value(column);
-            col_node.append_attribute("style").set_value(1);
-        }
+        workbook_style_table = style_writer(ws.get_parent()).get_style_by_hash();
     }
 
+    const auto &style_ids = style_table.empty() ? workbook_style_table : style_table;
+    std::map<column_t, std::string> styled_columns;
+
     std::unordered_map<std::string, std::string> hyperlink_references;
     
     auto sheet_data_node = root_node.append_child("sheetData");
@@ -412,6 +410,30 @@ std::string writer::write_worksheet(worksheet ws, const std::vector<std::string>
                             auto value_node = cell_node.append_child("v");
                             value_node.text().set(cell.get_value().as<bool>() ? 1 : 0);
                         }
+                        else if(cell.get_value().is(value::type::error))
+                        {
+                            cell_node.append_attribute("t").set_value("e");
+
+                            if(cell.has_formula())
+                            {
+                                cell_node.append_child("f").text().set(cell.get_formula().c_str());
+                            }
+
+                            cell_node.append_child("v").text().set(cell.get_value().to_string().c_str());
+                        }
+                        else if(cell.get_value().is(value::type::numeric) && !std::isfinite(cell.get_value().as<double>()))
+                        {
+                            // cells can't hold NaN or infinity, so they are written as the error
+                            // a formula giving them evaluates to
+                            cell_node.append_attribute("t").set_value("e");
+
+                            if(cell.has_formula())
+                            {
+                                cell_node.append_child("f").text().set(cell.get_formula().c_str());
+                            }
+
+                            cell_node.append_child("v").text().set("#NUM!");
+                        }
                         else if(cell.get_value().is(value::type::numeric))
                         {
                             if(cell.has_formula())
@@ -429,7 +451,9 @@ std::string writer::write_worksheet(worksheet ws, const std::vector<std::string>
                             }
                             else
                             {
-                                value_node.text().set(cell.get_value().as<double>());
+                                char buffer[detail::NumberBufferSize];
+                                detail::format_number(cell.get_value().as<double>(), buffer);
+                                value_node.text().set(buffer);
                             }
                         }
                     }
@@ -443,12 +467,28 @@ std::string writer::write_worksheet(worksheet ws, const std::vector<std::string>
                 
                 if(cell.has_style())
                 {
-                    cell_node.append_attribute("s").set_value(1);
+                    const auto &style_id = style_ids.at(cell.get_style_id());
+                    cell_node.append_attribute("s").set_value(style_id.c_str());
+                    styled_columns.emplace(cell_reference::column_index_from_string(cell.get_column()), style_id);
                 }
             }
         }
     }
 
+    // an empty cols element isn't valid, so it is left out when no cell is styled
+    if(column_styles && !styled_columns.empty())
+    {
+        auto cols_node = root_node.insert_child_before("cols", sheet_data_node);
+
+        for(const auto &column : styled_columns)
+        {
+            auto col_node = cols_node.append_child("col");
+            col_node.append_attribute("min").set_value(column.first);
+            col_node.append_attribute("max").set_value(column.first);
+            col_node.append_attribute("style").set_value(column.second.c_str());
+        }
+    }
+
     if(ws.has_auto_filter())
     {
         auto auto_filter_node = root_node.append_child("autoFilter");
@@ -555,13 +595,37 @@ std::string writer::write_content_types(const workbook &wb)
 
 std::string xlnt::writer::write_root_rels()
 {
-	std::vector<relationship> relationships;
+	static const std::string root_rels = write_relationships(
+	{
+		relationship(relationship::type::extended_properties, "rId3", "docProps/app.xml"),
+		relationship(relationship::type::core_properties, "rId2", "docProps/core.xml"),
+		relationship(relationship::type::office_document, "rId1", "xl/workbook.xml")
+	});
+
+	return root_rels;
+}
+
+std::string writer::write_root_rels(const workbook &wb)
+{
+    if(wb.d_->passthrough_root_relationships_.empty())
+    {
+        return write_root_rels();
+    }
+
+    std::vector<relationship> relationships;
 
-	relationships.push_back(relationship(relationship::type::extended_properties, "rId3", "docProps/app.xml"));
-	relationships.push_back(relationship(relationship::type::core_properties, "rId2", "docProps/core.xml"));
-	relationships.push_back(relationship(relationship::type::office_document, "rId1", "xl/workbook.xml"));
+    relationships.push_back(relationship(relationship::type::extended_properties, "rId3", "docProps/app.xml"));
+    relationships.push_back(relationship(relationship::type::core_properties, "rId2", "docProps/core.xml"));
+    relationships.push_back(relationship(relationship::type::office_document, "rId1", "xl/workbook.xml"));
+
+    // nothing refers to package relationships by id so those kept from a loaded package are renumbered
+    for(const auto &kept : wb.d_->passthrough_root_relationships_)
+    {
+        auto id = "rId" + std::to_string(relationships.size() + 1);
+        relationships.push_back(relationship(kept.get_type_string(), id, kept.get_target_uri()));
+    }
 
-	return write_relationships(relationships);
+    return write_relationships(relationships);
 }
 
 std::string writer::write_relationships(const std::vector<relationship> &relationships)
@@ -587,7 +651,9 @@ std::string writer::write_relationships(const std::vector<relationship> &relatio
     return ss.str();
 }
     
-std::string writer::write_theme()
+namespace {
+
+std::string build_theme()
 {
      pugi::xml_document doc;
      auto theme_node = doc.append_child("a:theme");
@@ -931,4 +997,13 @@ std::string writer::write_theme()
      return ss.str();
 }
 
+} // namespace
+
+std::string writer::write_theme()
+{
+    // the theme is the same for every workbook so its document is only built once
+    static const std::string theme = build_theme();
+    return theme;
+}
+
 }
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <ctime>
 #include <fstream>
 
 #ifdef _WIN32
@@ -85,74 +87,529 @@ std::vector<std::string> split_path(const std::string &path, char delim = direct
     return split;
 }
     
-uint32_t crc32buf(const char *buf, std::size_t len)
+const uint32_t LocalHeaderSignature = 0x04034b50;
+const uint32_t CentralHeaderSignature = 0x02014b50;
+const uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+const uint32_t Zip64EndOfCentralDirectorySignature = 0x06064b50;
+const uint32_t Zip64LocatorSignature = 0x07064b50;
+
+const std::size_t LocalHeaderSize = 30;
+const std::size_t CentralHeaderSize = 46;
+const std::size_t EndOfCentralDirectorySize = 22;
+const std::size_t Zip64EndOfCentralDirectorySize = 56;
+const std::size_t Zip64LocatorSize = 20;
+const std::size_t MaxCommentSize = 0xFFFF;
+
+// a zip64 extra field in a local header holds both sizes, in a central header only the
+// values which don't fit in their 32-bit fields, in the order written here
+const uint16_t Zip64ExtraTag = 0x0001;
+const uint16_t LocalZip64ExtraSize = 20;
+
+const uint16_t Zip64Marker16 = 0xFFFF;
+const uint32_t Zip64Marker32 = 0xFFFFFFFF;
+
+const uint16_t DefaultVersion = 20;
+const uint16_t Zip64Version = 45;
+const uint16_t DataDescriptorFlag = 0x0008;
+
+const std::size_t StreamChunkSize = 64 * 1024;
+
+uint16_t read_le16(const char *bytes)
 {
-    uint32_t oldcrc32 = 0xFFFFFFFF;
-    
-    uint32_t crc_32_tab[] = { /* CRC polynomial 0xedb88320 */
-        0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
-        0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
-        0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
-        0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
-        0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-        0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
-        0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
-        0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
-        0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
-        0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-        0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
-        0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
-        0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
-        0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
-        0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-        0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
-        0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
-        0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
-        0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
-        0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-        0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
-        0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
-        0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
-        0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
-        0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-        0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
-        0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
-        0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
-        0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
-        0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-        0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
-        0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
-        0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
-        0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
-        0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-        0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
-        0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
-        0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
-        0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
-        0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-        0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
-        0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
-        0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
-    };
-    
-#define UPDC32(octet,crc) (crc_32_tab[((crc)\
-^ ((uint8_t)octet)) & 0xff] ^ ((crc) >> 8))
-    
-    for ( ; len; --len, ++buf)
+    auto data = reinterpret_cast<const unsigned char *>(bytes);
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+uint32_t read_le32(const char *bytes)
+{
+    return (uint32_t)read_le16(bytes) | ((uint32_t)read_le16(bytes + 2) << 16);
+}
+
+uint64_t read_le64(const char *bytes)
+{
+    return (uint64_t)read_le32(bytes) | ((uint64_t)read_le32(bytes + 4) << 32);
+}
+
+using crc_tables = std::array<std::array<uint32_t, 256>, 8>;
+
+crc_tables build_crc_tables()
+{
+    crc_tables tables;
+
+    for(uint32_t i = 0; i < 256; i++)
+    {
+        auto crc = i;
+
+        for(int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+
+        tables[0][i] = crc;
+    }
+
+    for(std::size_t table = 1; table < 8; table++)
     {
-        oldcrc32 = UPDC32(*buf, oldcrc32);
+        for(std::size_t i = 0; i < 256; i++)
+        {
+            tables[table][i] = (tables[table - 1][i] >> 8) ^ tables[0][tables[table - 1][i] & 0xFF];
+        }
     }
-    
-    return ~oldcrc32;
+
+    return tables;
+}
+
+// slicing-by-8, which checksums several times faster than miniz's mz_crc32 so that it
+// doesn't dominate reading and writing large members
+uint32_t update_crc(uint32_t crc, const char *data, std::size_t size)
+{
+    static const crc_tables tables = build_crc_tables();
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    crc = ~crc;
+
+    for(; size >= 8; size -= 8, bytes += 8)
+    {
+        auto low = crc ^ ((uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24);
+        auto high = (uint32_t)bytes[4] | (uint32_t)bytes[5] << 8 | (uint32_t)bytes[6] << 16 | (uint32_t)bytes[7] << 24;
+
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+    }
+
+    for(; size > 0; size--, bytes++)
+    {
+        crc = tables[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+void write_le16(std::vector<char> &bytes, uint16_t value)
+{
+    bytes.push_back((char)(value & 0xFF));
+    bytes.push_back((char)(value >> 8));
+}
+
+void write_le32(std::vector<char> &bytes, uint32_t value)
+{
+    write_le16(bytes, (uint16_t)(value & 0xFFFF));
+    write_le16(bytes, (uint16_t)(value >> 16));
+}
+
+void write_le64(std::vector<char> &bytes, uint64_t value)
+{
+    write_le32(bytes, (uint32_t)(value & 0xFFFFFFFF));
+    write_le32(bytes, (uint32_t)(value >> 32));
+}
+
+void put_le32(char *bytes, uint32_t value)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        bytes[i] = (char)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void put_le64(char *bytes, uint64_t value)
+{
+    put_le32(bytes, (uint32_t)(value & 0xFFFFFFFF));
+    put_le32(bytes + 4, (uint32_t)(value >> 32));
+}
+
+// names are looked up case-insensitively, as miniz did
+std::string index_key(const std::string &name)
+{
+    std::string key(name);
+
+    for(auto &c : key)
+    {
+        if(c >= 'A' && c <= 'Z')
+        {
+            c = (char)(c - 'A' + 'a');
+        }
+    }
+
+    return key;
+}
+
+uint16_t dos_time(const xlnt::zip_info &info)
+{
+    return (uint16_t)(((info.date_time.hours & 0x1F) << 11) | ((info.date_time.minutes & 0x3F) << 5) | ((info.date_time.seconds / 2) & 0x1F));
+}
+
+uint16_t dos_date(const xlnt::zip_info &info)
+{
+    auto year = std::min(std::max(info.date_time.year - 1980, 0), 127);
+    return (uint16_t)((year << 9) | ((info.date_time.month & 0x0F) << 5) | (info.date_time.day & 0x1F));
+}
+
+void set_date_time(xlnt::zip_info &info, uint16_t time, uint16_t date)
+{
+    info.date_time.year = 1980 + (date >> 9);
+    info.date_time.month = (date >> 5) & 0x0F;
+    info.date_time.day = date & 0x1F;
+    info.date_time.hours = time >> 11;
+    info.date_time.minutes = (time >> 5) & 0x3F;
+    info.date_time.seconds = (time & 0x1F) * 2;
+}
+
+xlnt::zip_info make_info(const std::string &name)
+{
+    xlnt::zip_info info;
+    info.filename = name;
+
+    auto now = std::time(nullptr);
+    auto local = std::localtime(&now);
+    info.date_time.year = 1900 + local->tm_year;
+    info.date_time.month = 1 + local->tm_mon;
+    info.date_time.day = local->tm_mday;
+    info.date_time.hours = local->tm_hour;
+    info.date_time.minutes = local->tm_min;
+    info.date_time.seconds = local->tm_sec;
+
+    return info;
+}
+
+void write_local_header(std::vector<char> &bytes, const xlnt::zip_info &info, bool zip64)
+{
+    write_le32(bytes, LocalHeaderSignature);
+    write_le16(bytes, zip64 ? Zip64Version : DefaultVersion);
+    write_le16(bytes, info.flag_bits);
+    write_le16(bytes, info.compress_type);
+    write_le16(bytes, dos_time(info));
+    write_le16(bytes, dos_date(info));
+    write_le32(bytes, info.crc);
+    write_le32(bytes, zip64 ? Zip64Marker32 : (uint32_t)info.compress_size);
+    write_le32(bytes, zip64 ? Zip64Marker32 : (uint32_t)info.file_size);
+    write_le16(bytes, (uint16_t)info.filename.size());
+    write_le16(bytes, zip64 ? LocalZip64ExtraSize : 0);
+    bytes.insert(bytes.end(), info.filename.begin(), info.filename.end());
+
+    if(zip64)
+    {
+        write_le16(bytes, Zip64ExtraTag);
+        write_le16(bytes, LocalZip64ExtraSize - 4);
+        write_le64(bytes, info.file_size);
+        write_le64(bytes, info.compress_size);
+    }
+}
+
+void write_central_header(std::vector<char> &bytes, const xlnt::zip_info &info)
+{
+    std::vector<char> zip64;
+
+    if(info.file_size >= Zip64Marker32)
+    {
+        write_le64(zip64, info.file_size);
+    }
+
+    if(info.compress_size >= Zip64Marker32)
+    {
+        write_le64(zip64, info.compress_size);
+    }
+
+    if(info.header_offset >= Zip64Marker32)
+    {
+        write_le64(zip64, info.header_offset);
+    }
+
+    auto extract_version = zip64.empty() ? info.extract_version : std::max(info.extract_version, Zip64Version);
+    auto create_version = std::max<uint16_t>(info.create_version & 0xFF, extract_version);
+    auto extra_size = info.extra.size() + (zip64.empty() ? 0 : 4 + zip64.size());
+
+    write_le32(bytes, CentralHeaderSignature);
+    write_le16(bytes, (uint16_t)((info.create_system << 8) | create_version));
+    write_le16(bytes, extract_version);
+    write_le16(bytes, info.flag_bits);
+    write_le16(bytes, info.compress_type);
+    write_le16(bytes, dos_time(info));
+    write_le16(bytes, dos_date(info));
+    write_le32(bytes, info.crc);
+    write_le32(bytes, (uint32_t)std::min<uint64_t>(info.compress_size, Zip64Marker32));
+    write_le32(bytes, (uint32_t)std::min<uint64_t>(info.file_size, Zip64Marker32));
+    write_le16(bytes, (uint16_t)info.filename.size());
+    write_le16(bytes, (uint16_t)extra_size);
+    write_le16(bytes, (uint16_t)info.comment.size());
+    write_le16(bytes, (uint16_t)info.volume);
+    write_le16(bytes, (uint16_t)info.internal_attr);
+    write_le32(bytes, info.external_attr);
+    write_le32(bytes, (uint32_t)std::min<uint64_t>(info.header_offset, Zip64Marker32));
+    bytes.insert(bytes.end(), info.filename.begin(), info.filename.end());
+
+    if(!zip64.empty())
+    {
+        write_le16(bytes, Zip64ExtraTag);
+        write_le16(bytes, (uint16_t)zip64.size());
+        bytes.insert(bytes.end(), zip64.begin(), zip64.end());
+    }
+
+    bytes.insert(bytes.end(), info.extra.begin(), info.extra.end());
+    bytes.insert(bytes.end(), info.comment.begin(), info.comment.end());
+}
+
+mz_bool append_deflated(const void *data, int length, void *user)
+{
+    auto buffer = static_cast<std::vector<char> *>(user);
+    auto bytes = static_cast<const char *>(data);
+    buffer->insert(buffer->end(), bytes, bytes + length);
+
+    return MZ_TRUE;
 }
 
 } // namespace
 
 namespace  xlnt {
 
-zip_file::zip_file() : archive_(new mz_zip_archive())
+zip_info::zip_info()
+    : create_system(0),
+      create_version(0),
+      extract_version(DefaultVersion),
+      flag_bits(0),
+      compress_type(0),
+      volume(0),
+      internal_attr(0),
+      external_attr(0),
+      header_offset(0),
+      crc(0),
+      compress_size(0),
+      file_size(0)
+{
+    date_time.year = 1980;
+    date_time.month = 1;
+    date_time.day = 1;
+    date_time.hours = 0;
+    date_time.minutes = 0;
+    date_time.seconds = 0;
+}
+
+struct zip_streambuf::inflate_state
+{
+    tinfl_decompressor decompressor;
+    const mz_uint8 *next_in;
+    std::size_t remaining_in;
+    bool stored;
+    bool done;
+    std::size_t window_offset;
+    uint32_t crc;
+    mz_uint32 expected_crc;
+    mz_uint8 window[TINFL_LZ_DICT_SIZE];
+};
+
+zip_streambuf::zip_streambuf(zip_file &archive, const std::string &name) : state_(new inflate_state())
+{
+    auto &info = archive.find(name);
+
+    if(info.compress_type != 0 && info.compress_type != MZ_DEFLATED)
+    {
+        throw std::runtime_error("unsupported compression method");
+    }
+
+    auto data_offset = archive.get_data_offset(info);
+
+    tinfl_init(&state_->decompressor);
+    state_->next_in = reinterpret_cast<const mz_uint8 *>(archive.buffer_.data()) + data_offset;
+    state_->remaining_in = (std::size_t)info.compress_size;
+    state_->stored = info.compress_type == 0;
+    state_->done = false;
+    state_->window_offset = 0;
+    state_->crc = 0;
+    state_->expected_crc = info.crc;
+}
+zip_streambuf::~zip_streambuf()
+{
+}
+
+zip_streambuf::int_type zip_streambuf::underflow()
+{
+    if(gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    if(state_->done)
+    {
+        return traits_type::eof();
+    }
+
+    auto window_start = state_->window + state_->window_offset;
+    std::size_t consumed = state_->remaining_in;
+    std::size_t produced = TINFL_LZ_DICT_SIZE - state_->window_offset;
+
+    if(state_->stored)
+    {
+        produced = std::min(produced, consumed);
+        consumed = produced;
+        std::copy(state_->next_in, state_->next_in + produced, window_start);
+        state_->done = consumed == state_->remaining_in;
+    }
+    else
+    {
+        // all of the compressed data is in memory, so running out of input means it is truncated
+        auto status = tinfl_decompress(&state_->decompressor, state_->next_in, &consumed, state_->window, window_start, &produced, 0);
+
+        if(status == TINFL_STATUS_DONE)
+        {
+            state_->done = true;
+        }
+        else if(status != TINFL_STATUS_HAS_MORE_OUTPUT)
+        {
+            throw std::runtime_error("file couldn't be read");
+        }
+    }
+
+    state_->next_in += consumed;
+    state_->remaining_in -= consumed;
+    state_->crc = update_crc(state_->crc, reinterpret_cast<const char *>(window_start), produced);
+    state_->window_offset = (state_->window_offset + produced) & (TINFL_LZ_DICT_SIZE - 1);
+
+    if(state_->done && state_->crc != state_->expected_crc)
+    {
+        throw std::runtime_error("crc mismatch");
+    }
+
+    auto window_chars = reinterpret_cast<char *>(window_start);
+    setg(window_chars, window_chars, window_chars + produced);
+
+    if(produced == 0)
+    {
+        return traits_type::eof();
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+zip_istream::zip_istream(zip_file &archive, const std::string &name) : std::istream(nullptr), buffer_(archive, name)
+{
+    rdbuf(&buffer_);
+}
+
+struct zip_ostreambuf::deflate_state
+{
+    zip_file *archive;
+    zip_info info;
+    bool closed;
+    std::vector<char> input;
+    tdefl_compressor compressor;
+};
+
+zip_ostreambuf::zip_ostreambuf(zip_file &archive, const std::string &name, int level) : state_(new deflate_state())
+{
+    state_->archive = &archive;
+    state_->info = make_info(name);
+    state_->info.compress_type = MZ_DEFLATED;
+    state_->info.extract_version = Zip64Version;
+    state_->closed = false;
+    state_->input.resize(StreamChunkSize);
+
+    // the sizes aren't known until the member is closed, so the local header always
+    // leaves room for them in a zip64 field and is patched once they are
+    archive.drop_loaded_directory();
+    state_->info.header_offset = archive.buffer_.size();
+    write_local_header(archive.buffer_, state_->info, true);
+
+    auto flags = tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+
+    if(tdefl_init(&state_->compressor, &append_deflated, &archive.buffer_, (int)flags) != TDEFL_STATUS_OKAY)
+    {
+        throw std::runtime_error("write error");
+    }
+
+    setp(state_->input.data(), state_->input.data() + state_->input.size());
+}
+
+zip_ostreambuf::~zip_ostreambuf()
+{
+    try
+    {
+        close();
+    }
+    catch(std::runtime_error &)
+    {
+    }
+}
+
+void zip_ostreambuf::close()
+{
+    if(state_->closed)
+    {
+        return;
+    }
+
+    deflate_input(true);
+    state_->closed = true;
+    setp(nullptr, nullptr);
+
+    auto &buffer = state_->archive->buffer_;
+    auto &info = state_->info;
+    auto header_offset = (std::size_t)info.header_offset;
+    auto extra_offset = header_offset + LocalHeaderSize + info.filename.size();
+    info.compress_size = buffer.size() - (extra_offset + LocalZip64ExtraSize);
+
+    put_le32(&buffer[header_offset + 14], info.crc);
+    put_le64(&buffer[extra_offset + 4], info.file_size);
+    put_le64(&buffer[extra_offset + 12], info.compress_size);
+
+    state_->archive->end_entry(info);
+}
+
+void zip_ostreambuf::deflate_input(bool finish)
+{
+    auto size = (std::size_t)(pptr() - pbase());
+    auto &info = state_->info;
+
+    info.crc = update_crc(info.crc, pbase(), size);
+    info.file_size += size;
+
+    auto status = tdefl_compress_buffer(&state_->compressor, pbase(), size, finish ? TDEFL_FINISH : TDEFL_NO_FLUSH);
+
+    if(status != (finish ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY))
+    {
+        throw std::runtime_error("write error");
+    }
+
+    setp(pbase(), epptr());
+}
+
+zip_ostreambuf::int_type zip_ostreambuf::overflow(int_type c)
+{
+    if(state_->closed)
+    {
+        return traits_type::eof();
+    }
+
+    deflate_input(false);
+
+    if(!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+int zip_ostreambuf::sync()
+{
+    if(!state_->closed)
+    {
+        deflate_input(false);
+    }
+
+    return 0;
+}
+
+zip_ostream::zip_ostream(zip_file &archive, const std::string &name, int level) : std::ostream(nullptr), buffer_(archive, name, level)
+{
+    rdbuf(&buffer_);
+}
+
+void zip_ostream::close()
+{
+    buffer_.close();
+}
+
+zip_file::zip_file() : entries_end_(0)
 {
-    reset();
 }
 
 zip_file::zip_file(const std::string &filename) : zip_file()
@@ -172,15 +629,13 @@ zip_file::zip_file(const std::vector<unsigned char> &bytes) : zip_file()
 
 zip_file::~zip_file()
 {
-    reset();
 }
 
 void zip_file::load(std::istream &stream)
 {
     reset();
     buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
-    remove_comment();
-    start_read();
+    read_central_directory();
 }
 
 void zip_file::load(const std::string &filename)
@@ -194,8 +649,7 @@ void zip_file::load(const std::vector<unsigned char> &bytes)
 {
     reset();
     buffer_.assign(bytes.begin(), bytes.end());
-    remove_comment();
-    start_read();
+    read_central_directory();
 }
 
 void zip_file::save(const std::string &filename)
@@ -207,267 +661,286 @@ void zip_file::save(const std::string &filename)
 
 void zip_file::save(std::ostream &stream)
 {
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
+    // an archive saved as it was loaded is written back byte for byte
+    if(comment != loaded_comment_)
     {
-        mz_zip_writer_finalize_archive(archive_.get());
+        drop_loaded_directory();
     }
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED)
-    {
-        mz_zip_writer_end(archive_.get());
-    }
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_INVALID)
+
+    stream.write(buffer_.data(), (std::streamsize)buffer_.size());
+
+    if(buffer_.size() == entries_end_)
     {
-        start_read();
+        std::vector<char> directory;
+        write_central_directory(directory);
+        stream.write(directory.data(), (std::streamsize)directory.size());
     }
-    
-    append_comment();
-    stream.write(buffer_.data(), buffer_.size());
 }
 
 void zip_file::save(std::vector<unsigned char> &bytes)
 {
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
-    {
-        mz_zip_writer_finalize_archive(archive_.get());
-    }
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED)
+    if(comment != loaded_comment_)
     {
-        mz_zip_writer_end(archive_.get());
+        drop_loaded_directory();
     }
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_INVALID)
+
+    bytes.assign(buffer_.begin(), buffer_.end());
+
+    if(buffer_.size() == entries_end_)
     {
-        start_read();
+        std::vector<char> directory;
+        write_central_directory(directory);
+        bytes.insert(bytes.end(), directory.begin(), directory.end());
     }
-    
-    append_comment();
-    bytes.assign(buffer_.begin(), buffer_.end());
 }
 
-void zip_file::append_comment()
+void zip_file::reset()
 {
-    if(!comment.empty())
-    {
-        auto comment_length = std::min((uint16_t)comment.length(), std::numeric_limits<uint16_t>::max());
-        buffer_[buffer_.size() - 2] = comment_length & 0xFF;
-        buffer_[buffer_.size() - 1] = comment_length >> 8 & 0xFF;
-        std::copy(comment.begin(), comment.end(), std::back_inserter(buffer_));
-    }
+    buffer_.clear();
+    entries_end_ = 0;
+    entries_.clear();
+    index_.clear();
+    comment.clear();
+    loaded_comment_.clear();
 }
 
-void zip_file::remove_comment()
+void zip_file::read_central_directory()
 {
-    if(buffer_.empty()) return;
-    
-    std::size_t position = buffer_.size() - 1;
-    
-    for(; position >= 3; position--)
+    auto data = buffer_.data();
+    auto size = buffer_.size();
+
+    if(size < EndOfCentralDirectorySize)
     {
-        if(buffer_[position - 3] == 'P'
-           && buffer_[position - 2] == 'K'
-           && buffer_[position - 1] == '\x05'
-           && buffer_[position] == '\x06')
+        throw std::runtime_error("bad zip");
+    }
+
+    // the end of central directory record can only be followed by the archive comment
+    std::size_t end_record = size - EndOfCentralDirectorySize;
+    std::size_t search_limit = end_record > MaxCommentSize + 1 ? end_record - MaxCommentSize - 1 : 0;
+
+    while(read_le32(data + end_record) != EndOfCentralDirectorySignature)
+    {
+        if(end_record == search_limit)
         {
-            position = position + 17;
-            break;
+            throw std::runtime_error("didn't find end of central directory signature");
         }
+
+        end_record--;
     }
-    
-    if(position == 3)
+
+    uint64_t count = read_le16(data + end_record + 10);
+    uint64_t directory_size = read_le32(data + end_record + 12);
+    uint64_t directory_offset = read_le32(data + end_record + 16);
+    std::size_t comment_size = std::min<std::size_t>(read_le16(data + end_record + 20), size - end_record - EndOfCentralDirectorySize);
+
+    comment.assign(data + end_record + EndOfCentralDirectorySize, comment_size);
+    loaded_comment_ = comment;
+
+    if(end_record >= Zip64LocatorSize && read_le32(data + end_record - Zip64LocatorSize) == Zip64LocatorSignature)
     {
-        throw std::runtime_error("didn't find end of central directory signature");
+        auto record = read_le64(data + end_record - Zip64LocatorSize + 8);
+
+        if(record + Zip64EndOfCentralDirectorySize > end_record || read_le32(data + record) != Zip64EndOfCentralDirectorySignature)
+        {
+            throw std::runtime_error("bad zip");
+        }
+
+        count = read_le64(data + record + 32);
+        directory_size = read_le64(data + record + 40);
+        directory_offset = read_le64(data + record + 48);
     }
-    
-    uint16_t length = buffer_[position + 1];
-    length = (length << 8) + buffer_[position];
-    position += 2;
-    
-    if(length != 0)
+
+    if(directory_offset > end_record || directory_size > end_record - directory_offset)
     {
-        comment = std::string(buffer_.data() + position, buffer_.data() + position + length);
-        buffer_.resize(buffer_.size() - length);
-        buffer_[buffer_.size() - 1] = 0;
-        buffer_[buffer_.size() - 2] = 0;
+        throw std::runtime_error("bad zip");
     }
-}
 
-void zip_file::reset()
-{
-    switch(archive_->m_zip_mode)
-    {
-    case MZ_ZIP_MODE_READING:
-        mz_zip_reader_end(archive_.get());
-        break;
-    case MZ_ZIP_MODE_WRITING:
-        mz_zip_writer_finalize_archive(archive_.get());
-        mz_zip_writer_end(archive_.get());
-        break;
-    case MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED:
-        mz_zip_writer_end(archive_.get());
-        break;
-    case MZ_ZIP_MODE_INVALID:
-        break;
-    }
-    
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_INVALID)
+    auto position = (std::size_t)directory_offset;
+    auto directory_end = (std::size_t)(directory_offset + directory_size);
+
+    for(uint64_t i = 0; i < count; i++)
     {
-        throw std::runtime_error("");
+        auto header = data + position;
+
+        if(position + CentralHeaderSize > directory_end || read_le32(header) != CentralHeaderSignature)
+        {
+            throw std::runtime_error("bad zip");
+        }
+
+        std::size_t name_size = read_le16(header + 28);
+        std::size_t extra_size = read_le16(header + 30);
+        std::size_t entry_comment_size = read_le16(header + 32);
+        auto entry_size = CentralHeaderSize + name_size + extra_size + entry_comment_size;
+
+        if(position + entry_size > directory_end)
+        {
+            throw std::runtime_error("bad zip");
+        }
+
+        zip_info info;
+        info.create_version = read_le16(header + 4) & 0xFF;
+        info.create_system = read_le16(header + 4) >> 8;
+        info.extract_version = read_le16(header + 6);
+        info.flag_bits = read_le16(header + 8);
+        info.compress_type = read_le16(header + 10);
+        set_date_time(info, read_le16(header + 12), read_le16(header + 14));
+        info.crc = read_le32(header + 16);
+        info.compress_size = read_le32(header + 20);
+        info.file_size = read_le32(header + 24);
+        info.volume = read_le16(header + 34);
+        info.internal_attr = read_le16(header + 36);
+        info.external_attr = read_le32(header + 38);
+        info.header_offset = read_le32(header + 42);
+        info.filename.assign(header + CentralHeaderSize, name_size);
+        info.comment.assign(header + CentralHeaderSize + name_size + extra_size, entry_comment_size);
+
+        // values too large for their fields are in a zip64 extra field, which is rebuilt on
+        // save; the other extra fields are kept as they are
+        auto extra = header + CentralHeaderSize + name_size;
+        auto extra_end = extra + extra_size;
+
+        while(extra + 4 <= extra_end)
+        {
+            auto field = extra + 4;
+            auto field_end = std::min(field + read_le16(extra + 2), extra_end);
+
+            if(read_le16(extra) == Zip64ExtraTag)
+            {
+                for(auto value : { &info.file_size, &info.compress_size, &info.header_offset })
+                {
+                    if(*value == Zip64Marker32 && field + 8 <= field_end)
+                    {
+                        *value = read_le64(field);
+                        field += 8;
+                    }
+                }
+            }
+            else
+            {
+                info.extra.append(extra, field_end);
+            }
+
+            extra = field_end;
+        }
+
+        index_[index_key(info.filename)] = entries_.size();
+        entries_.push_back(info);
+        position += entry_size;
     }
 
-    buffer_.clear();
-    comment.clear();
-    
-    start_write();
-    mz_zip_writer_finalize_archive(archive_.get());
-    mz_zip_writer_end(archive_.get());
+    entries_end_ = (std::size_t)directory_offset;
 }
 
-zip_info zip_file::getinfo(const std::string &name)
+void zip_file::write_central_directory(std::vector<char> &bytes) const
 {
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+    auto directory_offset = (uint64_t)entries_end_;
+
+    for(auto &info : entries_)
     {
-        start_read();
+        write_central_header(bytes, info);
     }
 
-    int index = mz_zip_reader_locate_file(archive_.get(), name.c_str(), nullptr, 0);
+    auto directory_size = (uint64_t)bytes.size();
+    auto count = (uint64_t)entries_.size();
 
-    if(index == -1)
+    if(count >= Zip64Marker16 || directory_size >= Zip64Marker32 || directory_offset >= Zip64Marker32)
     {
-        throw std::runtime_error("not found");
+        write_le32(bytes, Zip64EndOfCentralDirectorySignature);
+        write_le64(bytes, Zip64EndOfCentralDirectorySize - 12);
+        write_le16(bytes, Zip64Version);
+        write_le16(bytes, Zip64Version);
+        write_le32(bytes, 0);
+        write_le32(bytes, 0);
+        write_le64(bytes, count);
+        write_le64(bytes, count);
+        write_le64(bytes, directory_size);
+        write_le64(bytes, directory_offset);
+
+        write_le32(bytes, Zip64LocatorSignature);
+        write_le32(bytes, 0);
+        write_le64(bytes, directory_offset + directory_size);
+        write_le32(bytes, 1);
     }
 
-    return getinfo(index);
+    auto comment_size = std::min(comment.size(), MaxCommentSize);
+
+    write_le32(bytes, EndOfCentralDirectorySignature);
+    write_le16(bytes, 0);
+    write_le16(bytes, 0);
+    write_le16(bytes, (uint16_t)std::min<uint64_t>(count, Zip64Marker16));
+    write_le16(bytes, (uint16_t)std::min<uint64_t>(count, Zip64Marker16));
+    write_le32(bytes, (uint32_t)std::min<uint64_t>(directory_size, Zip64Marker32));
+    write_le32(bytes, (uint32_t)std::min<uint64_t>(directory_offset, Zip64Marker32));
+    write_le16(bytes, (uint16_t)comment_size);
+    bytes.insert(bytes.end(), comment.begin(), comment.begin() + (std::ptrdiff_t)comment_size);
 }
 
-zip_info zip_file::getinfo(int index)
+const zip_info &zip_file::find(const std::string &name) const
 {
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_READING)
+    auto match = index_.find(index_key(name));
+
+    if(match == index_.end())
     {
-        start_read();
+        throw std::runtime_error("not found");
     }
 
-    mz_zip_archive_file_stat stat;
-    mz_zip_reader_file_stat(archive_.get(), index, &stat);
-
-    zip_info result;
-
-    result.filename = std::string(stat.m_filename, stat.m_filename + std::strlen(stat.m_filename));
-    result.comment = std::string(stat.m_comment, stat.m_comment + stat.m_comment_size);
-    result.compress_size = (std::size_t)stat.m_comp_size;
-    result.file_size = (std::size_t)stat.m_uncomp_size;
-    result.header_offset = (std::size_t)stat.m_local_header_ofs;
-    result.crc = stat.m_crc32;
-    tm *time = localtime(&stat.m_time);
-    result.date_time.year = 1900 + time->tm_year;
-    result.date_time.month = 1 + time->tm_mon;
-    result.date_time.day = time->tm_mday;
-    result.date_time.hours = time->tm_hour;
-    result.date_time.minutes = time->tm_min;
-    result.date_time.seconds = time->tm_sec;
-    result.flag_bits = stat.m_bit_flag;
-    result.internal_attr = stat.m_internal_attr;
-    result.external_attr = stat.m_external_attr;
-    result.extract_version = stat.m_version_needed;
-    result.create_version = stat.m_version_made_by;
-    result.volume = stat.m_file_index;
-    result.create_system = stat.m_method;
-    
-    return result;
+    return entries_[match->second];
 }
 
-void zip_file::start_read()
+std::size_t zip_file::get_data_offset(const zip_info &info) const
 {
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_READING) return;
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING)
-    {
-        mz_zip_writer_finalize_archive(archive_.get());
-    }
-    
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED)
+    // the data follows the local header, whose name and extra fields can differ in length
+    // from those in the central directory
+    auto header = buffer_.data() + info.header_offset;
+
+    if(info.header_offset + LocalHeaderSize > entries_end_ || read_le32(header) != LocalHeaderSignature)
     {
-        mz_zip_writer_end(archive_.get());
+        throw std::runtime_error("bad zip");
     }
-        
-    if(!mz_zip_reader_init_mem(archive_.get(), buffer_.data(), buffer_.size(), 0))
+
+    auto data_offset = (std::size_t)info.header_offset + LocalHeaderSize + read_le16(header + 26) + read_le16(header + 28);
+
+    if(data_offset > entries_end_ || info.compress_size > entries_end_ - data_offset)
     {
         throw std::runtime_error("bad zip");
     }
+
+    return data_offset;
 }
 
-std::size_t write_callback(void *opaque, mz_uint64 file_ofs, const void *pBuf, std::size_t n)
+void zip_file::drop_loaded_directory()
 {
-    auto buffer = (std::vector<char> *)opaque;
-    
-    if(file_ofs + n > buffer->size())
-    {
-        buffer->resize(file_ofs + n);
-    }
+    buffer_.resize(entries_end_);
+}
 
-    for(std::size_t i = 0; i < n; i++)
-    {
-        (*buffer)[(std::size_t)file_ofs + i] = ((const char *)pBuf)[i];
-    }
+void zip_file::add_entry(zip_info info, const char *data, std::uint64_t size)
+{
+    drop_loaded_directory();
+
+    // the sizes are known up front, so the local header has them and no data descriptor follows
+    info.header_offset = buffer_.size();
+    info.compress_size = size;
+    info.flag_bits &= ~DataDescriptorFlag;
 
-    return n;
+    auto zip64 = info.file_size >= Zip64Marker32 || info.compress_size >= Zip64Marker32;
+    info.extract_version = zip64 ? Zip64Version : DefaultVersion;
+
+    write_local_header(buffer_, info, zip64);
+    buffer_.insert(buffer_.end(), data, data + size);
+
+    end_entry(info);
 }
 
-void zip_file::start_write()
+void zip_file::end_entry(const zip_info &info)
 {
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_WRITING) return;
-    
-    switch(archive_->m_zip_mode)
-    {
-        case MZ_ZIP_MODE_READING:
-        {
-            mz_zip_archive archive_copy;
-	    std::memset(&archive_copy, 0, sizeof(mz_zip_archive));
-            std::vector<char> buffer_copy(buffer_.begin(), buffer_.end());
-            
-            if(!mz_zip_reader_init_mem(&archive_copy, buffer_copy.data(), buffer_copy.size(), 0))
-            {
-                throw std::runtime_error("bad zip");
-            }
-            
-            mz_zip_reader_end(archive_.get());
-            
-            archive_->m_pWrite = &write_callback;
-            archive_->m_pIO_opaque = &buffer_;
-            buffer_ = std::vector<char>();
-            
-            if(!mz_zip_writer_init(archive_.get(), 0))
-            {
-                throw std::runtime_error("bad zip");
-            }
-            
-            for(int i = 0; i < (int)archive_copy.m_total_files; i++)
-            {
-                if(!mz_zip_writer_add_from_zip_reader(archive_.get(), &archive_copy, i))
-                {
-                    throw std::runtime_error("fail");
-                }
-            }
-            
-            mz_zip_reader_end(&archive_copy);
-            return;
-        }
-        case MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED:
-            mz_zip_writer_end(archive_.get());
-            break;
-        default:
-            break;
-    }
-
-    archive_->m_pWrite = &write_callback;
-    archive_->m_pIO_opaque = &buffer_;
+    entries_end_ = buffer_.size();
+    index_[index_key(info.filename)] = entries_.size();
+    entries_.push_back(info);
+}
 
-    if(!mz_zip_writer_init(archive_.get(), 0))
-    {
-        throw std::runtime_error("bad zip");
-    }
+zip_info zip_file::getinfo(const std::string &name)
+{
+    return find(name);
 }
 
 void zip_file::write(const std::string &filename)
@@ -493,47 +966,109 @@ void zip_file::write(const std::string &filename, const std::string &arcname)
 
 void zip_file::writestr(const std::string &arcname, const std::string &bytes)
 {
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+    writestr(make_info(arcname), bytes);
+}
+
+void zip_file::writestr(const zip_info &info, const std::string &bytes)
+{
+    if(info.filename.empty() || info.date_time.year < 1980)
     {
-        start_write();
+        throw std::runtime_error("must specify a filename and valid date (year >= 1980");
     }
 
-    if(!mz_zip_writer_add_mem(archive_.get(), arcname.c_str(), bytes.data(), bytes.size(), MZ_BEST_COMPRESSION))
+    zip_info entry(info);
+    entry.file_size = bytes.size();
+    entry.crc = update_crc(0, bytes.data(), bytes.size());
+
+    std::size_t deflated_size = 0;
+    auto flags = tdefl_create_comp_flags_from_zip_params(MZ_BEST_COMPRESSION, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    auto deflated = static_cast<char *>(tdefl_compress_mem_to_heap(bytes.data(), bytes.size(), &deflated_size, (int)flags));
+
+    if(deflated == nullptr)
     {
         throw std::runtime_error("write error");
     }
-}
 
-void zip_file::writestr(const zip_info &info, const std::string &bytes)
-{
-    if(info.filename.empty() || info.date_time.year < 1980)
+    // data that doesn't get any smaller is stored as it is
+    if(deflated_size < bytes.size())
     {
-        throw std::runtime_error("must specify a filename and valid date (year >= 1980");
+        entry.compress_type = MZ_DEFLATED;
+        add_entry(entry, deflated, deflated_size);
     }
-    
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_WRITING)
+    else
     {
-        start_write();
+        entry.compress_type = 0;
+        add_entry(entry, bytes.data(), bytes.size());
     }
-    
-    auto crc = crc32buf(bytes.c_str(), bytes.size());
-    
-    if(!mz_zip_writer_add_mem_ex(archive_.get(), info.filename.c_str(), bytes.data(), bytes.size(), info.comment.c_str(), (mz_uint16)info.comment.size(), MZ_BEST_COMPRESSION, 0, crc))
+
+    mz_free(deflated);
+}
+
+void zip_file::write_from(zip_file &source, const std::string &arcname)
+{
+    auto info = source.find(arcname);
+    auto data_offset = source.get_data_offset(info);
+
+    if(&source == this)
     {
-        throw std::runtime_error("write error");
+        std::vector<char> data(buffer_.begin() + (std::ptrdiff_t)data_offset, buffer_.begin() + (std::ptrdiff_t)(data_offset + info.compress_size));
+        add_entry(info, data.data(), data.size());
+        return;
     }
+
+    add_entry(info, source.buffer_.data() + data_offset, info.compress_size);
+}
+
+void zip_file::write_deflated(const std::string &arcname, const std::string &deflated, std::uint64_t file_size, std::uint32_t crc)
+{
+    auto info = make_info(arcname);
+    info.compress_type = MZ_DEFLATED;
+    info.file_size = file_size;
+    info.crc = crc;
+
+    add_entry(info, deflated.data(), deflated.size());
 }
 
 std::string zip_file::read(const zip_info &info)
 {
-    std::size_t size;
-    char *data = (char *)mz_zip_reader_extract_file_to_heap(archive_.get(), info.filename.c_str(), &size, 0);
-    if(data == nullptr)
+    auto &entry = find(info.filename);
+    auto data = reinterpret_cast<const mz_uint8 *>(buffer_.data() + get_data_offset(entry));
+    std::string extracted((std::size_t)entry.file_size, '\0');
+
+    if(entry.compress_type == 0)
+    {
+        if(entry.compress_size != entry.file_size)
+        {
+            throw std::runtime_error("file couldn't be read");
+        }
+
+        std::copy(data, data + entry.file_size, extracted.begin());
+    }
+    else if(entry.compress_type == MZ_DEFLATED)
     {
-	throw std::runtime_error("file couldn't be read");
+        tinfl_decompressor decompressor;
+        tinfl_init(&decompressor);
+
+        auto out = reinterpret_cast<mz_uint8 *>(&extracted[0]);
+        auto consumed = (std::size_t)entry.compress_size;
+        auto produced = extracted.size();
+        auto status = tinfl_decompress(&decompressor, data, &consumed, out, out, &produced, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+        if(status != TINFL_STATUS_DONE || produced != extracted.size())
+        {
+            throw std::runtime_error("file couldn't be read");
+        }
     }
-    std::string extracted(data, data + size);
-    mz_free(data);
+    else
+    {
+        throw std::runtime_error("unsupported compression method");
+    }
+
+    if(update_crc(0, extracted.data(), extracted.size()) != entry.crc)
+    {
+        throw std::runtime_error("crc mismatch");
+    }
+
     return extracted;
 }
 
@@ -544,14 +1079,7 @@ std::string zip_file::read(const std::string &name)
 
 bool zip_file::has_file(const std::string &name)
 {
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_READING)
-    {
-        start_read();
-    }
-
-    int index = mz_zip_reader_locate_file(archive_.get(), name.c_str(), nullptr, 0);
-
-    return index != -1;
+    return index_.find(index_key(name)) != index_.end();
 }
 
 bool zip_file::has_file(const zip_info &name)
@@ -561,19 +1089,7 @@ bool zip_file::has_file(const zip_info &name)
 
 std::vector<zip_info> zip_file::infolist()
 {
-    if(archive_->m_zip_mode != MZ_ZIP_MODE_READING)
-    {
-        start_read();
-    }
-
-    std::vector<zip_info> info;
-
-    for(std::size_t i = 0; i < mz_zip_reader_get_num_files(archive_.get()); i++)
-    {
-        info.push_back(getinfo((int)i));
-    }
-
-    return info;
+    return entries_;
 }
 
 std::vector<std::string> zip_file::namelist()
@@ -654,7 +1170,7 @@ void zip_file::printdir(std::ostream &stream)
     stream << "  Length " << "  " << "   " << "Date" << "   " << " " << "Time " << "   " << "Name" << std::endl;
     stream << "---------  ---------- -----   ----" << std::endl;
     
-    std::size_t sum_length = 0;
+    std::uint64_t sum_length = 0;
     std::size_t file_count = 0;
 
     for(auto &member : infolist())
@@ -697,17 +1213,13 @@ void zip_file::printdir(std::ostream &stream)
 
 std::pair<bool, std::string> zip_file::testzip()
 {
-    if(archive_->m_zip_mode == MZ_ZIP_MODE_INVALID)
+    for(auto &file : entries_)
     {
-        throw std::runtime_error("not open");
-    }
-
-    for(auto &file : infolist())
-    {
-        auto content = read(file);
-        auto crc = crc32buf(content.c_str(), content.size());
-        
-        if(crc != file.crc)
+        try
+        {
+            read(file);
+        }
+        catch(std::runtime_error &)
         {
             return {false, file.filename};
         }
@@ -0,0 +1,179 @@
+#include <cstdlib>
+#include <new>
+
+#include <xlnt/common/types.hpp>
+
+#include "allocation_counter.hpp"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+std::atomic<std::size_t> &AllocationCounter::total()
+{
+    static std::atomic<std::size_t> allocations(0);
+    return allocations;
+}
+
+namespace {
+
+void *allocate(std::size_t size)
+{
+    AllocationCounter::total()++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *allocate_or_throw(std::size_t size)
+{
+    if(void *block = allocate(size))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    return allocate_or_throw(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate_or_throw(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    return allocate(size);
+}
+
+void operator delete(void *block) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+void operator delete[](void *block) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+void operator delete(void *block, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+void operator delete[](void *block, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+// used in place of the unsized forms when the compiler supports sized deallocation (C++14)
+void operator delete(void *block, std::size_t) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+void operator delete[](void *block, std::size_t) XLNT_NOEXCEPT
+{
+    std::free(block);
+}
+
+#ifdef __cpp_aligned_new
+
+// the forms for over-aligned types (C++17), which need memory that can be freed knowing only
+// its alignment
+namespace {
+
+void *allocate_aligned(std::size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::total()++;
+    auto align = static_cast<std::size_t>(alignment);
+    size = size == 0 ? 1 : size;
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    void *block = nullptr;
+    return posix_memalign(&block, align < sizeof(void *) ? sizeof(void *) : align, size) == 0 ? block : nullptr;
+#endif
+}
+
+void *allocate_aligned_or_throw(std::size_t size, std::align_val_t alignment)
+{
+    if(void *block = allocate_aligned(size, alignment))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc();
+}
+
+void free_aligned(void *block)
+{
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+} // namespace
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned_or_throw(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned_or_throw(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    return allocate_aligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    return allocate_aligned(size, alignment);
+}
+
+void operator delete(void *block, std::align_val_t) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+void operator delete[](void *block, std::align_val_t) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+void operator delete(void *block, std::align_val_t, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+void operator delete[](void *block, std::align_val_t, const std::nothrow_t &) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+void operator delete(void *block, std::size_t, std::align_val_t) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+void operator delete[](void *block, std::size_t, std::align_val_t) XLNT_NOEXCEPT
+{
+    free_aligned(block);
+}
+
+#endif
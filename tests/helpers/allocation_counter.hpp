@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Counts the allocations made through the global operator new since it was constructed.
+// The replacement operators that do the counting are defined in allocation_counter.cpp,
+// which is linked into the test runner.
+class AllocationCounter
+{
+public:
+    AllocationCounter() : start_(total())
+    {
+
+    }
+
+    std::size_t get_count() const
+    {
+        return total() - start_;
+    }
+
+    static std::atomic<std::size_t> &total();
+
+private:
+    std::size_t start_;
+};
@@ -5,6 +5,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
+#include "helpers/allocation_counter.hpp"
 
 class test_cell : public CxxTest::TestSuite
 {
@@ -164,6 +165,14 @@ public:
         TS_ASSERT(cell.get_value().is(xlnt::value::type::numeric));
     }
 
+    void test_numeric_to_string()
+    {
+        TS_ASSERT_EQUALS(xlnt::value(0.1).to_string(), "0.1");
+        TS_ASSERT_EQUALS(xlnt::value(0.1 + 0.2).to_string(), "0.30000000000000004");
+        TS_ASSERT_EQUALS(xlnt::value(-1e-7).to_string(), "-1E-7");
+        TS_ASSERT_EQUALS(xlnt::value(42).to_string(), "42");
+    }
+
     void test_string()
     {
         xlnt::worksheet ws = wb.create_sheet();
@@ -309,6 +318,32 @@ public:
         TS_ASSERT(cell.get_value().is(xlnt::value::type::string));
     }
 
+    void test_guess_types_classification()
+    {
+        wb.set_guess_types(true);
+        xlnt::worksheet ws = wb.create_sheet();
+        xlnt::cell cell(ws, "A1");
+
+        cell.set_value("12:30");
+        TS_ASSERT(cell.is_date());
+        TS_ASSERT_EQUALS(cell.get_value(), xlnt::time(12, 30));
+
+        cell.set_value("0.5%");
+        TS_ASSERT_DELTA(0.005, cell.get_value().as<double>(), 1e-9);
+
+        cell.set_value("FALSE");
+        TS_ASSERT(cell.get_value().is(xlnt::value::type::boolean));
+
+        cell.set_value("#REF!");
+        TS_ASSERT(cell.get_value().is(xlnt::value::type::error));
+
+        cell.set_value("#hashtag");
+        TS_ASSERT(cell.get_value().is(xlnt::value::type::string));
+
+        cell.set_value("1,000");
+        TS_ASSERT(cell.get_value().is(xlnt::value::type::string));
+    }
+
     void test_set_bad_type()
     {
         xlnt::worksheet ws = wb.create_sheet();
@@ -418,6 +453,20 @@ public:
         TS_ASSERT(ws.get_cell("B15").offset(1, 2).get_reference() == "C17");
     }
 
+    void test_value_move()
+    {
+        xlnt::value source(std::string(100, 'x'));
+
+        AllocationCounter counter;
+        xlnt::value moved(std::move(source));
+        xlnt::value assigned;
+        assigned = std::move(moved);
+        TS_ASSERT_EQUALS(counter.get_count(), 0);
+
+        TS_ASSERT(source.is(xlnt::value::type::null));
+        TS_ASSERT_EQUALS(assigned, std::string(100, 'x'));
+    }
+
 private:
     xlnt::workbook wb;
 };
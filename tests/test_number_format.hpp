@@ -108,6 +108,28 @@ public:
         //cell = worksheet.cell("A1");
     }
 
+    void test_is_date_format()
+    {
+        TS_ASSERT(xlnt::number_format::is_date_format("mm-dd-yy"));
+        TS_ASSERT(xlnt::number_format::is_date_format("m/d/yy h:mm"));
+        TS_ASSERT(xlnt::number_format::is_date_format("h:mm:ss AM/PM"));
+        TS_ASSERT(xlnt::number_format::is_date_format("[h]:mm:ss"));
+        TS_ASSERT(xlnt::number_format::is_date_format("[$-409]mmmm d, yyyy"));
+        TS_ASSERT(!xlnt::number_format::is_date_format("General"));
+        TS_ASSERT(!xlnt::number_format::is_date_format("0.00%"));
+        TS_ASSERT(!xlnt::number_format::is_date_format("0.00_);[Red]\\(0.00\\)"));
+        TS_ASSERT(!xlnt::number_format::is_date_format("\"days\" 0"));
+    }
+
+    void test_custom_date_format_is_date()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.get_cell("A1").set_value(40847.5);
+        ws.get_cell("A1").get_style().get_number_format().set_format_code("dd/mm/yyyy hh:mm");
+        TS_ASSERT(ws.get_cell("A1").is_date());
+    }
+
     void check_date_pair(int count, const std::string &date_string)
     {
         //cell.value = strptime(date_string, "%Y-%m-%d");
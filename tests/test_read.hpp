@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <cxxtest/TestSuite.h>
@@ -134,6 +135,37 @@ public:
         TS_ASSERT_EQUALS(code, expected);
     }
     
+    void test_read_styles_round_trip()
+    {
+        xlnt::workbook original;
+        auto ws = original.get_active_sheet();
+        xlnt::style st;
+        xlnt::font bold_font;
+        bold_font.bold = true;
+        bold_font.color_ = xlnt::color("FFFF0000");
+        st.set_font(bold_font);
+        xlnt::fill solid_fill;
+        solid_fill.type_ = xlnt::fill::type::solid;
+        solid_fill.start_color = xlnt::color("FF00FF00");
+        st.set_fill(solid_fill);
+        st.get_number_format().set_format_code("0.000");
+        ws.get_cell("A1").set_value(1.5);
+        ws.get_cell("A1").set_style(st);
+        ws.get_cell("A2").set_value("text");
+        ws.get_cell("A2").set_style(st);
+        
+        std::vector<unsigned char> data;
+        TS_ASSERT(original.save(data));
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(data));
+        
+        auto loaded_ws = loaded.get_active_sheet();
+        const auto a1 = loaded_ws.get_cell("A1");
+        const auto a2 = loaded_ws.get_cell("A2");
+        TS_ASSERT_EQUALS(a1.get_style_id(), a2.get_style_id());
+        TS_ASSERT(a1.get_style() == st);
+    }
+    
     xlnt::workbook date_mac_1904()
     {
         auto path = PathHelper::GetDataDirectory("/reader/date_1904.xlsx");
@@ -184,6 +216,39 @@ public:
         TS_ASSERT_EQUALS(ws_mac.get_cell("A1").get_value(), ws_win.get_cell("A1").get_value());
     }
     
+    void test_round_trip_mac_dates()
+    {
+        auto wb_mac = date_mac_1904();
+        std::vector<unsigned char> data;
+        TS_ASSERT(wb_mac.save(data));
+
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(data));
+        TS_ASSERT_EQUALS(loaded["Sheet1"].get_cell("A1").get_value(), xlnt::datetime(2011, 10, 31));
+    }
+    
+    void test_round_trip_errors()
+    {
+        xlnt::workbook wb;
+        wb.set_guess_types(true);
+        auto ws = wb.get_active_sheet();
+        ws.get_cell("A1").set_value("#REF!");
+        ws.get_cell("A2").set_value("#N/A");
+        TS_ASSERT(ws.get_cell("A1").get_value().is(xlnt::value::type::error));
+        TS_ASSERT(ws.get_cell("A2").get_value().is(xlnt::value::type::error));
+
+        std::vector<unsigned char> data;
+        TS_ASSERT(wb.save(data));
+
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(data));
+        auto loaded_ws = loaded.get_active_sheet();
+        TS_ASSERT(loaded_ws.get_cell("A1").get_value().is(xlnt::value::type::error));
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("A1").get_value().to_string(), "#REF!");
+        TS_ASSERT(loaded_ws.get_cell("A2").get_value().is(xlnt::value::type::error));
+        TS_ASSERT_EQUALS(loaded_ws.get_cell("A2").get_value().to_string(), "#N/A");
+    }
+    
     void test_repair_central_directory()
     {
         std::string data_a = "foobarbaz" + xlnt::reader::CentralDirectorySignature;
@@ -457,7 +522,169 @@ public:
         auto ws = wb.get_active_sheet();
         TS_ASSERT_EQUALS(ws.get_auto_filter().to_string(), "A1:B6");
     }
-    
+
+    void test_read_worksheet_markup()
+    {
+        std::string rows = "<row r=\"1\" spans=\"1:5\">"
+            "<c r=\"A1\" t=\"s\"><v>1</v></c>"
+            "<c r=\"B1\" t=\"inlineStr\"><is><t>a &amp; b&#x20AC;</t></is></c>"
+            "<c r=\"C1\"><f>A1&amp;\"&gt;\"</f><v>2.5</v></c>"
+            "<c r=\"D1\" t=\"str\"><v>x\r\ny</v></c>"
+            "<c r=\"E1\" t=\"b\"><v>1</v></c>"
+            "</row>"
+            "<row r=\"2\"><c r=\"A2\"><v>3</v></c></row>";
+
+        // the comment sends the second sheet through the generic parser
+        for(auto sheet_data : { "<sheetData>" + rows + "</sheetData>", "<sheetData><!-- -->" + rows + "</sheetData>" })
+        {
+            xlnt::workbook wb;
+            auto ws = wb.get_active_sheet();
+            xlnt::reader::read_worksheet(ws, "<worksheet>" + sheet_data + "</worksheet>", { "zero", "one" }, {});
+
+            TS_ASSERT_EQUALS(ws.get_cell("A1").get_value(), "one");
+            TS_ASSERT_EQUALS(ws.get_cell("B1").get_value(), "a & b\xE2\x82\xAC");
+            TS_ASSERT_EQUALS(ws.get_cell("C1").get_formula(), "A1&\">\"");
+            TS_ASSERT_EQUALS(ws.get_cell("C1").get_value(), 2.5);
+            TS_ASSERT_EQUALS(ws.get_cell("D1").get_value(), "x\ny");
+            TS_ASSERT_EQUALS(ws.get_cell("E1").get_value(), true);
+            // cells of rows without spans are not read
+            TS_ASSERT(ws.get_cell("A2").get_value().is(xlnt::value::type::null));
+        }
+    }
+
+    void test_read_blank_styled_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::style date_style;
+        date_style.get_number_format().set_format_code("yyyy-mm-dd");
+        ws.get_cell("Z1").set_style(date_style);
+        std::vector<std::size_t> style_ids = { 0, ws.get_cell("Z1").get_style_id() };
+
+        xlnt::reader::read_worksheet(ws, "<worksheet><sheetData><row r=\"1\" spans=\"1:3\">"
+            "<c r=\"A1\" s=\"0\"/><c r=\"B1\" s=\"1\"/><c r=\"C1\" s=\"1\"><v>40000</v></c>"
+            "</row></sheetData></worksheet>", {}, style_ids);
+
+        // blank cells only take their style, whatever its number format
+        TS_ASSERT(ws.get_cell("A1").get_value().is(xlnt::value::type::null));
+        TS_ASSERT(ws.get_cell("B1").get_value().is(xlnt::value::type::null));
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_style_id(), style_ids[1]);
+        TS_ASSERT(ws.get_cell("C1").get_value().is(xlnt::value::type::numeric));
+        TS_ASSERT(ws.get_cell("C1").is_date());
+    }
+
+    void test_read_overflowing_number()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::reader::read_worksheet(ws, "<worksheet><sheetData><row r=\"1\" spans=\"1:2\">"
+            "<c r=\"A1\"><v>1e400</v></c><c r=\"B1\"><v>-1e400</v></c>"
+            "</row></sheetData></worksheet>", {}, {});
+
+        TS_ASSERT(ws.get_cell("A1").get_value().is(xlnt::value::type::numeric));
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_value().as<double>(), HUGE_VAL);
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value().as<double>(), -HUGE_VAL);
+
+        // guessing keeps such text as text
+        wb.set_guess_types(true);
+        ws.get_cell("C1").set_value("1e400");
+        TS_ASSERT(ws.get_cell("C1").get_value().is(xlnt::value::type::string));
+    }
+
+    void test_read_worksheet_projection()
+    {
+        std::string rows = "<row r=\"1\" spans=\"1:3\">"
+            "<c r=\"A1\"><v>1</v></c>"
+            "<c r=\"B1\" t=\"inlineStr\"><is><t>skipped &gt; <i/></t></is></c>"
+            "<c r=\"C1\"><f>A1*2</f><v>2</v></c>"
+            "</row>"
+            "<row r=\"2\" spans=\"1:3\"><c r=\"A2\"><v>3</v></c><c r=\"B2\"/><c r=\"C2\" t=\"str\"><v>four</v></c></row>"
+            "<row r=\"3\" spans=\"1:3\"><c r=\"A3\"><v>5</v></c><c r=\"C3\"><v>6</v></c></row>"
+            "<row r=\"4\"/>";
+
+        xlnt::load_options options;
+        options.set_columns({ 2, 0 });
+        options.set_rows(1, 2);
+
+        // the comment sends the second sheet through the generic parser
+        for(auto sheet_data : { "<sheetData>" + rows + "</sheetData>", "<sheetData><!-- -->" + rows + "</sheetData>" })
+        {
+            xlnt::workbook wb;
+            auto ws = wb.get_active_sheet();
+            xlnt::reader::read_worksheet(ws, "<worksheet>" + sheet_data + "</worksheet>", {}, {}, options);
+
+            TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 4);
+            TS_ASSERT_EQUALS(ws.get_cell("A2").get_value(), 3);
+            TS_ASSERT_EQUALS(ws.get_cell("C2").get_value(), "four");
+            TS_ASSERT_EQUALS(ws.get_cell("A3").get_value(), 5);
+            TS_ASSERT_EQUALS(ws.get_cell("C3").get_value(), 6);
+        }
+    }
+
+    void test_load_options()
+    {
+        xlnt::workbook original;
+        original.get_active_sheet().set_title("first");
+        auto second = original.create_sheet("second");
+
+        for(row_t row = 0; row < 10; row++)
+        {
+            for(column_t column = 0; column < 5; column++)
+            {
+                original.get_sheet_by_name("first").get_cell(xlnt::cell_reference(column, row)).set_value("first " + std::to_string(row * 5 + column));
+                second.get_cell(xlnt::cell_reference(column, row)).set_value(static_cast<int>(row * 5 + column));
+            }
+        }
+
+        std::vector<unsigned char> data;
+        TS_ASSERT(original.save(data));
+
+        xlnt::load_options options;
+        options.set_sheets({ "second" });
+        options.set_columns({ 1 });
+        options.set_rows(0, 3);
+
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(data, options));
+        TS_ASSERT_EQUALS(loaded.get_sheet_names(), std::vector<std::string>({ "second" }));
+
+        auto ws = loaded.get_sheet_by_name("second");
+        TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 4);
+        TS_ASSERT_EQUALS(ws.get_cell("B1").get_value(), 1);
+        TS_ASSERT_EQUALS(ws.get_cell("B4").get_value(), 16);
+
+        // what is saved is what was loaded, not the sheet in the source file
+        std::vector<unsigned char> resaved;
+        TS_ASSERT(loaded.save(resaved));
+        xlnt::workbook reloaded;
+        TS_ASSERT(reloaded.load(resaved));
+        TS_ASSERT_EQUALS(reloaded.get_active_sheet().get_cell_collection().size(), 4);
+        TS_ASSERT_EQUALS(reloaded.get_active_sheet().get_cell("B4").get_value(), 16);
+    }
+
+    void test_read_dimension_hint()
+    {
+        std::string rows = "<row r=\"1\" spans=\"1:2\"><c r=\"A1\"><v>1</v></c><c r=\"B1\"><v>2</v></c></row>"
+            "<row r=\"2\" spans=\"1:2\"><c r=\"A2\"><v>3</v></c></row>";
+
+        // the dimension only sizes the rows, so one that is wrong, malformed or missing leaves
+        // the cells as they are, and one far too large doesn't make the sheet reserve its height
+        for(auto dimension : { "<dimension ref=\"A1:B2\"/>", "<dimension ref=\"A1:XFD1048576\"/>", "<dimension ref=\"1:A\"/>", "" })
+        {
+            for(auto comment : { "", "<!-- -->" })
+            {
+                xlnt::workbook wb;
+                auto ws = wb.get_active_sheet();
+                xlnt::reader::read_worksheet(ws, std::string("<worksheet>") + dimension + "<sheetData>" + comment + rows + "</sheetData></worksheet>", {}, {});
+
+                TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 3);
+                TS_ASSERT_EQUALS(ws.get_cell("B1").get_value(), 2);
+                TS_ASSERT_EQUALS(ws.get_cell("A2").get_value(), 3);
+                TS_ASSERT_LESS_THAN(ws.get_memory_usage().hash_tables, 64 * 1024);
+            }
+        }
+    }
+
     void test_bad_formats_xlsb()
     {
         auto path = PathHelper::GetDataDirectory("/genuine/a.xlsb");
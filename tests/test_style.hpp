@@ -30,7 +30,8 @@ public:
     
     void test_create_style_table()
     {
-        TS_ASSERT_EQUALS(5, writer_.get_styles().size());
+        // default, percentage, datetime and number_00; G1 uses the default style
+        TS_ASSERT_EQUALS(4, writer_.get_styles().size());
     }
 
     void test_write_style_table()
@@ -61,7 +62,19 @@ public:
 
     void test_style_unicity()
     {
-        TS_SKIP("not implemented");
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        xlnt::style st;
+        st.set_number_format(xlnt::number_format(xlnt::number_format::format::number_00));
+        ws.get_cell("A1").set_style(st);
+        ws.get_cell("A2").set_style(st);
+        ws.get_cell("A3").get_style().set_number_format(xlnt::number_format(xlnt::number_format::format::number_00));
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_style_id(), ws.get_cell("A2").get_style_id());
+        TS_ASSERT_EQUALS(xlnt::style_writer(wb).get_styles().size(), 2);
+        
+        auto style_ids = xlnt::style_writer(wb).get_style_by_hash();
+        TS_ASSERT_EQUALS(style_ids.at(ws.get_cell("A1").get_style_id()), "1");
+        TS_ASSERT_EQUALS(style_ids.at(ws.get_cell("A3").get_style_id()), "1");
     }
 
     void test_fonts()
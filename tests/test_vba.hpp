@@ -1,10 +1,39 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
+#include "helpers/path_helper.hpp"
 
 class test_vba : public CxxTest::TestSuite
 {
+public:
+    void test_save_keeps_vba_project()
+    {
+        auto path = PathHelper::GetDataDirectory("/reader/vba-test.xlsm");
+        xlnt::workbook wb;
+        wb.load(path);
+        wb.get_active_sheet().get_cell("A1").set_value("changed");
+
+        std::vector<unsigned char> saved;
+        wb.save(saved);
+
+        xlnt::zip_file source(path);
+        xlnt::zip_file archive(saved);
+        TS_ASSERT(archive.read("xl/vbaProject.bin") == source.read("xl/vbaProject.bin"));
+        TS_ASSERT(archive.read("xl/drawings/vmlDrawing1.vml") == source.read("xl/drawings/vmlDrawing1.vml"));
+        TS_ASSERT(archive.read("xl/worksheets/_rels/sheet1.xml.rels") == source.read("xl/worksheets/_rels/sheet1.xml.rels"));
+
+        auto content_types = xlnt::reader::read_content_types(archive);
+        TS_ASSERT_EQUALS(xlnt::reader::determine_document_type(content_types), "excel");
+        auto vba_type = std::find_if(content_types.begin(), content_types.end(), [](const std::pair<std::string, std::string> &t) { return t.first == "/xl/vbaProject.bin"; });
+        TS_ASSERT(vba_type != content_types.end());
+
+        auto relationships = xlnt::reader::read_relationships(archive, "xl/workbook.xml");
+        auto vba_relationship = std::find_if(relationships.begin(), relationships.end(), [](const xlnt::relationship &r) { return r.get_target_uri() == "xl/vbaProject.bin"; });
+        TS_ASSERT(vba_relationship != relationships.end());
+        TS_ASSERT_EQUALS(vba_relationship->get_type_string(), "http://schemas.microsoft.com/office/2006/relationships/vbaProject");
+    }
 };
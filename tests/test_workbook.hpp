@@ -5,6 +5,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
+#include "helpers/allocation_counter.hpp"
 #include "helpers/temporary_file.hpp"
 
 class test_workbook : public CxxTest::TestSuite
@@ -159,6 +160,333 @@ public:
         TS_ASSERT(!wb.has_named_range("test_nr"));
     }
 
+    void test_lookups_follow_changes()
+    {
+        xlnt::workbook wb;
+        wb.create_sheet();
+        wb.create_sheet();
+        TS_ASSERT_EQUALS(wb[1].get_title(), "Sheet1");
+        TS_ASSERT_EQUALS(wb[2].get_title(), "Sheet2");
+
+        // a title given up by a rename is reused by the next unnamed sheet
+        wb[1].set_title("renamed");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Sheet1"), nullptr);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("renamed"), wb[1]);
+        TS_ASSERT_EQUALS(wb.create_sheet().get_title(), "Sheet1");
+        TS_ASSERT_EQUALS(wb.create_sheet("renamed").get_title(), "renamed1");
+
+        wb[1].create_named_range("shared", "A1");
+        wb[2].create_named_range("shared", "B2");
+        TS_ASSERT_EQUALS(wb.get_named_range("shared"), wb[1].get_range("A1"));
+
+        // sheets after a removed one move up and are still found by title and named range
+        wb.remove_sheet(wb[1]);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Sheet2"), wb[1]);
+        TS_ASSERT_EQUALS(wb.get_named_range("shared"), wb[1].get_range("B2"));
+        wb.remove_named_range("shared");
+        TS_ASSERT(!wb.has_named_range("shared"));
+
+        wb.create_sheet(0, "inserted");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("inserted"), wb[0]);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Sheet"), wb[wb.get_sheet_names().size() - 1]);
+        TS_ASSERT_EQUALS(wb.get_relationship("rId2").get_target_uri(), "sharedStrings.xml");
+    }
+
+    void test_create_many_sheets()
+    {
+        xlnt::workbook wb;
+
+        for(int i = 1; i <= 5000; i++)
+        {
+            wb.create_sheet();
+            wb.create_named_range("range" + std::to_string(i), wb.get_sheet_by_name("Sheet" + std::to_string(i)), "A1");
+        }
+
+        TS_ASSERT_EQUALS(wb.get_sheet_names().size(), 5001);
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("Sheet5000"), wb[5000]);
+        TS_ASSERT_EQUALS(wb.get_named_range("range2500"), wb[2500].get_range("A1"));
+    }
+
+    void test_handles_survive_new_sheets()
+    {
+        xlnt::workbook wb;
+        auto first = wb.create_sheet("first");
+        auto first_cell = first.get_cell("B2");
+        first_cell.set_value("kept");
+
+        for(int i = 0; i < 100; i++)
+        {
+            wb.create_sheet();
+        }
+
+        auto inserted = wb.create_sheet(1, "inserted");
+        wb.remove_sheet(wb[0]);
+
+        TS_ASSERT_EQUALS(first.get_title(), "first");
+        TS_ASSERT_EQUALS(wb.get_sheet_by_name("first"), first);
+        TS_ASSERT_EQUALS(wb[0], inserted);
+        TS_ASSERT_EQUALS(first_cell.get_value(), "kept");
+        TS_ASSERT_EQUALS(first.get_cell("B2").get_value(), "kept");
+    }
+
+    void test_copies_are_independent()
+    {
+        xlnt::workbook original;
+        auto original_sheet = original.get_active_sheet();
+        auto kept = original_sheet.get_cell("A1");
+        kept.set_value("original");
+        original_sheet.get_cell("B2").set_value(2);
+
+        xlnt::workbook copy(original);
+        auto copy_sheet = copy.get_active_sheet();
+
+        // writing through a handle taken before the copy only changes the original
+        kept.set_value("changed");
+        TS_ASSERT_EQUALS(copy_sheet.get_cell("A1").get_value(), "original");
+        TS_ASSERT_EQUALS(original_sheet.get_cell("A1").get_value(), "changed");
+
+        copy_sheet.get_cell("B2").set_value(3);
+        copy_sheet.get_cell("C3").set_value("new");
+        TS_ASSERT_EQUALS(original_sheet.get_cell("B2").get_value(), 2);
+        TS_ASSERT_EQUALS(original_sheet.get_cell_collection().size(), 2);
+
+        xlnt::workbook second_copy(copy);
+        copy_sheet.get_cell("B2").set_value(4);
+        TS_ASSERT_EQUALS(second_copy.get_active_sheet().get_cell("B2").get_value(), 3);
+        TS_ASSERT_EQUALS(second_copy.get_active_sheet().get_cell("C3").get_value(), "new");
+        TS_ASSERT_EQUALS(copy_sheet.get_cell("B2").get_value(), 4);
+    }
+
+    void test_copies_keep_date_flags()
+    {
+        xlnt::workbook original;
+        auto sheet = original.get_active_sheet();
+        sheet.get_cell("A1").set_value(1);
+        sheet.get_cell("B1").set_value(1);
+        sheet.get_cell("C1").set_value(1);
+        sheet.get_cell("D1").set_value(1);
+
+        xlnt::workbook copy(original);
+
+        // the date setters mark the cell before setting its value, which mustn't reach the copy
+        sheet.get_cell("A1").set_value(xlnt::time(12, 0));
+        sheet.get_cell("B1").set_value(xlnt::timedelta(1, 0, 0, 0, 0));
+        sheet.get_cell("C1").set_value(xlnt::date(2015, 1, 1));
+        sheet.get_cell("D1").set_value(xlnt::datetime(2015, 1, 1, 12));
+
+        for(auto reference : { "A1", "B1", "C1", "D1" })
+        {
+            TS_ASSERT(sheet.get_cell(reference).is_date());
+            TS_ASSERT(!copy.get_active_sheet().get_cell(reference).is_date());
+            TS_ASSERT_EQUALS(copy.get_active_sheet().get_cell(reference).get_value(), 1);
+        }
+    }
+
+    void test_add_sheet_from_other_workbook_keeps_styles()
+    {
+        xlnt::workbook source;
+        auto sheet = source.get_active_sheet();
+        sheet.set_title("styled");
+        xlnt::style bold;
+        xlnt::font bold_font;
+        bold_font.bold = true;
+        bold.set_font(bold_font);
+        xlnt::style percent;
+        percent.get_number_format().set_format_code("0.0%");
+
+        sheet.get_cell("A1").set_value(1);
+        sheet.get_cell("A1").set_style(bold);
+        sheet.get_cell("B1").set_value(0.5);
+        sheet.get_cell("B1").set_style(percent);
+
+        // the destination registry has fewer styles than the ids the sheet's cells hold
+        xlnt::workbook destination;
+        destination.add_sheet(sheet);
+
+        auto added = destination.get_sheet_by_name("styled");
+        TS_ASSERT(added.get_cell("A1").get_style() == bold);
+        TS_ASSERT(added.get_cell("B1").get_style() == percent);
+        TS_ASSERT(sheet.get_cell("A1").get_style() == bold);
+        TS_ASSERT(sheet.get_cell("B1").get_style() == percent);
+    }
+
+    void test_held_style_survives_other_cells_styles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        auto &held = ws.get_cell("A1").get_style();
+
+        for(row_t row = 1; row <= 100; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(0, row)).get_style();
+        }
+
+        held.get_number_format().set_format_code("0.0%");
+        TS_ASSERT_EQUALS(ws.get_cell("A1").get_style().get_number_format().get_format_string(), "0.0%");
+        TS_ASSERT_EQUALS(ws.get_cell("A2").get_style().get_number_format().get_format_string(), "General");
+    }
+
+    void test_styles_of_removed_cells_are_recycled()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        for(row_t row = 0; row < 1000; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(0, row)).get_style();
+        }
+
+        // the cells hold no values so they are all removed
+        ws.garbage_collect();
+        std::vector<unsigned char> data;
+        TS_ASSERT(wb.save(data));
+        auto styles = wb.get_memory_usage().workbook_parts.styles;
+
+        for(row_t row = 0; row < 1000; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(1, row)).get_style();
+        }
+
+        TS_ASSERT_EQUALS(wb.get_memory_usage().workbook_parts.styles, styles);
+    }
+
+    void test_reorder_does_not_copy_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+
+        for(row_t row = 0; row < 1000; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(0, row)).set_value(std::string(100, 'x'));
+        }
+
+        // copying the sheet's cells would allocate at least once for each of their strings
+        AllocationCounter counter;
+
+        for(int i = 0; i < 10; i++)
+        {
+            wb.create_sheet(0);
+        }
+
+        wb.remove_sheet(wb[0]);
+        TS_ASSERT_LESS_THAN(counter.get_count(), 1000);
+        TS_ASSERT_EQUALS(ws.get_cell("A1000").get_value(), std::string(100, 'x'));
+    }
+
+    void test_memory_usage()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.set_title("data");
+        auto empty = wb.get_memory_usage();
+
+        for(row_t row = 0; row < 100; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(0, row)).set_value(std::string(1000, 'x'));
+            ws.get_cell(xlnt::cell_reference(1, row)).set_formula("=SUM(A1:A100)" + std::string(100, ' '));
+        }
+
+        ws.get_cell("C1").set_comment(xlnt::comment(std::string(1000, 'c'), "author"));
+
+        auto report = wb.get_memory_usage();
+        TS_ASSERT_EQUALS(report.sheets.size(), 1);
+        TS_ASSERT_EQUALS(report.sheets[0].first, "data");
+
+        auto sheet = report.sheets[0].second;
+        TS_ASSERT_EQUALS(sheet.total(), ws.get_memory_usage().total());
+        TS_ASSERT_LESS_THAN(100 * 1000, sheet.strings);
+        TS_ASSERT_LESS_THAN(100 * 100, sheet.formulas);
+        TS_ASSERT_LESS_THAN(1000, sheet.comments);
+        TS_ASSERT_LESS_THAN(201 * sizeof(std::string), sheet.cells);
+        TS_ASSERT_LESS_THAN(0, sheet.hash_tables);
+        TS_ASSERT_LESS_THAN(0, report.workbook_parts.styles);
+        TS_ASSERT_LESS_THAN(empty.total().total(), report.total().total());
+        TS_ASSERT_EQUALS(report.total().total(), report.workbook_parts.total() + sheet.total());
+
+        // a copied sheet shares its rows with the original until either changes them
+        xlnt::workbook copy(wb);
+        wb.add_sheet(copy.get_active_sheet());
+        report = wb.get_memory_usage();
+        TS_ASSERT_EQUALS(report.sheets.size(), 2);
+        TS_ASSERT_EQUALS(report.sheets[1].second.cells, 0);
+        TS_ASSERT_EQUALS(report.sheets[1].second.strings, 0);
+
+        // the registry's font names and number format codes are counted with the styles
+        auto styles = report.workbook_parts.styles;
+        xlnt::style custom;
+        xlnt::font font;
+        font.name = std::string(1000, 'f');
+        custom.set_font(font);
+        custom.get_number_format().set_format_code(std::string(1000, '0'));
+        ws.get_cell("D1").set_style(custom);
+        TS_ASSERT_LESS_THAN(styles + 2000, wb.get_memory_usage().workbook_parts.styles);
+    }
+
+    void test_memory_resource()
+    {
+        class counting_resource : public xlnt::memory_resource
+        {
+        public:
+            counting_resource() : allocations(0), outstanding(0)
+            {
+            }
+
+            std::size_t allocations;
+            std::size_t outstanding;
+
+        protected:
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                allocations++;
+                outstanding += bytes;
+                return xlnt::default_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override
+            {
+                outstanding -= bytes;
+                xlnt::default_resource()->deallocate(pointer, bytes, alignment);
+            }
+        };
+
+        counting_resource counter;
+
+        {
+            xlnt::workbook wb(&counter);
+            TS_ASSERT_EQUALS(wb.get_memory_resource(), &counter);
+
+            for(row_t row = 0; row < 100; row++)
+            {
+                wb.get_active_sheet().get_cell(xlnt::cell_reference(0, row)).set_value(static_cast<int>(row));
+            }
+
+            TS_ASSERT_LESS_THAN(200, counter.allocations);
+
+            xlnt::workbook copy(wb);
+            copy.get_active_sheet().get_cell("A1").set_value("changed");
+            TS_ASSERT_EQUALS(copy.get_memory_resource(), &counter);
+            TS_ASSERT_EQUALS(wb.get_active_sheet().get_cell("A1").get_value(), 0);
+        }
+
+        TS_ASSERT_EQUALS(counter.outstanding, 0);
+
+        // a sheet added to a workbook with another resource gets its own rows, so the arena the
+        // original was allocated from can be released while the copy is in use
+        xlnt::workbook kept;
+        std::unique_ptr<xlnt::monotonic_resource> arena(new xlnt::monotonic_resource());
+
+        {
+            xlnt::workbook temporary(arena.get());
+            auto ws = temporary.create_sheet("arena");
+            ws.get_cell("B2").set_value("in arena");
+            kept.add_sheet(ws);
+            TS_ASSERT_LESS_THAN(0, arena->get_reserved_size());
+        }
+
+        arena.reset();
+        TS_ASSERT_EQUALS(kept.get_sheet_by_name("arena").get_cell("B2").get_value(), "in arena");
+    }
+
     void test_add_local_named_range()
     {
         TemporaryFile temp_file;
@@ -5,6 +5,7 @@
 
 #include "pugixml.hpp"
 #include <xlnt/xlnt.hpp>
+#include "helpers/allocation_counter.hpp"
 
 class test_worksheet : public CxxTest::TestSuite
 {
@@ -638,6 +639,23 @@ public:
         TS_ASSERT_EQUALS(ws.get_point_pos(ws.get_cell("X11").get_anchor()), xlnt::cell_reference("X11"));
     }
     
+    void test_set_column_values()
+    {
+        xlnt::workbook wb;
+        wb.set_guess_types(true);
+        auto ws = wb.create_sheet();
+        ws.set_column_values("B2", {"1.5", "text", "TRUE", "", "50%"});
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_value(), 1.5);
+        TS_ASSERT_EQUALS(ws.get_cell("B3").get_value(), "text");
+        TS_ASSERT_EQUALS(ws.get_cell("B4").get_value(), true);
+        TS_ASSERT(ws.get_cell("B5").get_value().is(xlnt::value::type::null));
+        TS_ASSERT_EQUALS(ws.get_cell("B6").get_value(), 0.5);
+
+        wb.set_guess_types(false);
+        ws.set_column_values("C1", {"1.5"});
+        TS_ASSERT_EQUALS(ws.get_cell("C1").get_value(), "1.5");
+    }
+    
     void test_page_setup()
     {
     	xlnt::page_setup p;
@@ -657,6 +675,162 @@ public:
         TS_ASSERT(p.get_vertical_centered());
     }
 
+    void test_merged_range_lookup()
+    {
+        xlnt::worksheet ws = wb_.create_sheet();
+        ws.get_cell("B2").set_value("kept");
+        ws.get_cell("C3").set_value("cleared");
+        ws.merge_cells("B2:D1000000");
+
+        // merging only changes the cells that already exist
+        TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 2);
+        TS_ASSERT_EQUALS(ws.get_cell("B2").get_value(), "kept");
+        TS_ASSERT_EQUALS(ws.get_cell("C3").get_value(), "");
+        TS_ASSERT_EQUALS(ws.get_merged_range("D500000"), "B2:D1000000");
+        TS_ASSERT(!ws.has_merged_range("E2"));
+        TS_ASSERT_THROWS(ws.get_merged_range("A1"), std::runtime_error);
+
+        std::vector<xlnt::range_reference> tiles;
+
+        for(row_t row = 0; row < 200; row += 2)
+        {
+            for(column_t column = 10; column < 210; column += 2)
+            {
+                tiles.push_back(xlnt::range_reference(column, row, column + 1, row + 1));
+            }
+        }
+
+        ws.merge_cells(tiles);
+
+        for(row_t row = 0; row < 200; row += 2)
+        {
+            ws.merge_cells(xlnt::range_reference(300, row, 301, row + 1));
+        }
+
+        TS_ASSERT_EQUALS(ws.get_merged_ranges().size(), 10101);
+        TS_ASSERT_EQUALS(ws.get_merged_range(xlnt::cell_reference(13, 7)), xlnt::range_reference(12, 6, 13, 7));
+        TS_ASSERT_EQUALS(ws.get_merged_range(xlnt::cell_reference(301, 199)), xlnt::range_reference(300, 198, 301, 199));
+        TS_ASSERT(ws.get_cell(xlnt::cell_reference(11, 1)).is_merged());
+
+        auto overlapping = ws.get_merged_ranges(xlnt::range_reference(3, 1, 11, 2));
+        TS_ASSERT_EQUALS(overlapping.size(), 3);
+        TS_ASSERT_EQUALS(overlapping[0], "B2:D1000000");
+        TS_ASSERT_EQUALS(overlapping[1], xlnt::range_reference(10, 0, 11, 1));
+        TS_ASSERT_EQUALS(overlapping[2], xlnt::range_reference(10, 2, 11, 3));
+
+        for(std::size_t i = 0; i < tiles.size(); i += 2)
+        {
+            ws.unmerge_cells(tiles[i]);
+        }
+
+        TS_ASSERT_THROWS(ws.unmerge_cells(tiles[0]), std::runtime_error);
+        TS_ASSERT(!ws.has_merged_range(xlnt::cell_reference(10, 0)));
+        TS_ASSERT(ws.has_merged_range(xlnt::cell_reference(12, 0)));
+        TS_ASSERT_EQUALS(ws.get_merged_ranges().size(), 5101);
+        TS_ASSERT_EQUALS(ws.get_merged_ranges()[1], tiles[1]);
+    }
+
+    void test_sparse_range()
+    {
+        xlnt::worksheet ws = wb_.create_sheet();
+        ws.get_cell("C2").set_value(1);
+        ws.get_cell("B3").set_value(2);
+        ws.get_cell("ZZ100000").set_value(3);
+        ws.get_cell("B100").set_value(4);
+        ws.get_cell("A1").set_value(5);
+        ws.get_cell("D4");
+
+        // rows 7 and 8 hold enough cells for their columns to be ordered with a bitmap, and
+        // more cells than the second range is wide
+        for(column_t column = 0; column < 200; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 6)).set_value(6);
+
+            if(column % 2 == 0)
+            {
+                ws.get_cell(xlnt::cell_reference(column, 7)).set_value(7);
+            }
+        }
+
+        std::vector<std::string> found;
+
+        for(auto cell : xlnt::sparse_range(ws, "B2:ZZ100000"))
+        {
+            found.push_back(cell.get_reference().to_string());
+        }
+
+        TS_ASSERT_EQUALS(found.size(), 4 + 199 + 99);
+        TS_ASSERT_EQUALS(found[0], "C2");
+        TS_ASSERT_EQUALS(found[1], "B3");
+        TS_ASSERT_EQUALS(found[2], "B7");
+        TS_ASSERT_EQUALS(found[200], "GR7");
+        TS_ASSERT_EQUALS(found[201], "C8");
+        TS_ASSERT_EQUALS(found[202], "E8");
+        TS_ASSERT_EQUALS(found[found.size() - 2], "B100");
+        TS_ASSERT_EQUALS(found.back(), "ZZ100000");
+
+        xlnt::sparse_range by_column(ws, "B1:C9", xlnt::major_order::column);
+        found.clear();
+
+        for(auto cell : by_column)
+        {
+            found.push_back(cell.get_reference().to_string());
+        }
+
+        std::vector<std::string> expected = {"B3", "B7", "C2", "C7", "C8"};
+        TS_ASSERT_EQUALS(found, expected);
+
+        // no cells are created by the queries
+        TS_ASSERT_EQUALS(ws.get_cell_collection().size(), 6 + 200 + 100);
+        TS_ASSERT(xlnt::sparse_range(ws, "E1:F5").empty());
+        TS_ASSERT_EQUALS(xlnt::sparse_range(ws, "B2:ZZ100000").size(), 4 + 199 + 99);
+        TS_ASSERT_EQUALS(by_column.size(), 5);
+
+        // cells written through the range stay in its sheet when the rows are shared with a copy
+        xlnt::workbook copy(wb_);
+        auto copy_sheet = copy.get_sheet_by_index(static_cast<std::size_t>(wb_.get_index(ws)));
+
+        for(auto cell : xlnt::sparse_range(ws, "A1:C3"))
+        {
+            cell.set_value(0);
+        }
+
+        TS_ASSERT_EQUALS(ws.get_cell("C2").get_value(), 0);
+        TS_ASSERT_EQUALS(ws.get_cell("B3").get_value(), 0);
+        TS_ASSERT_EQUALS(copy_sheet.get_cell("C2").get_value(), 1);
+        TS_ASSERT_EQUALS(copy_sheet.get_cell("B3").get_value(), 2);
+    }
+
+    void test_growth_does_not_copy_cells()
+    {
+        xlnt::worksheet ws = wb_.create_sheet();
+
+        for(column_t column = 0; column < 1000; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 0)).set_value(std::string(100, 'x'));
+        }
+
+        // each new cell allocates a handful of times, copying the first row would add a thousand more each time it grows
+        AllocationCounter new_cells;
+
+        for(column_t column = 1000; column < 2000; column++)
+        {
+            ws.get_cell(xlnt::cell_reference(column, 0));
+        }
+
+        TS_ASSERT_LESS_THAN(new_cells.get_count(), 3000);
+
+        AllocationCounter new_rows;
+
+        for(row_t row = 1; row <= 1000; row++)
+        {
+            ws.get_cell(xlnt::cell_reference(0, row));
+        }
+
+        TS_ASSERT_LESS_THAN(new_rows.get_count(), 5000);
+        TS_ASSERT_EQUALS(ws.get_cell(xlnt::cell_reference(999, 0)).get_value(), std::string(100, 'x'));
+    }
+
 private:
     xlnt::workbook wb_;
 };
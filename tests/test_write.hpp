@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <limits>
 #include <cxxtest/TestSuite.h>
 
 #include <xlnt/xlnt.hpp>
@@ -108,6 +109,35 @@ public:
         TS_ASSERT(Helper::EqualsFileContent(PathHelper::GetDataDirectory() + "/writer/expected/sheet1_style.xml", content));
     }
 
+    void test_write_style_table_without_styled_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.get_cell("A1").set_value(1);
+        auto style_id_by_hash = xlnt::style_writer(wb).get_style_by_hash();
+        auto content = xlnt::writer::write_worksheet(ws, {}, style_id_by_hash);
+        TS_ASSERT_EQUALS(content.find("<cols"), std::string::npos);
+    }
+
+    void test_write_non_finite_numbers()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.get_active_sheet();
+        ws.get_cell("A1").set_value(std::numeric_limits<double>::quiet_NaN());
+        ws.get_cell("A2").set_value(std::numeric_limits<double>::infinity());
+        auto content = xlnt::writer::write_worksheet(ws);
+        TS_ASSERT_EQUALS(content.find("NaN"), std::string::npos);
+        TS_ASSERT_EQUALS(content.find("INF"), std::string::npos);
+
+        std::vector<unsigned char> data;
+        TS_ASSERT(wb.save(data));
+        xlnt::workbook loaded;
+        TS_ASSERT(loaded.load(data));
+        TS_ASSERT(loaded.get_active_sheet().get_cell("A1").get_value().is(xlnt::value::type::error));
+        TS_ASSERT_EQUALS(loaded.get_active_sheet().get_cell("A1").get_value().to_string(), "#NUM!");
+        TS_ASSERT_EQUALS(loaded.get_active_sheet().get_cell("A2").get_value().to_string(), "#NUM!");
+    }
+
     void test_write_height()
     {
 		auto ws = wb_.create_sheet();
@@ -219,6 +249,37 @@ public:
         auto content = xlnt::writer::write_worksheet(ws, {}, {});
         TS_ASSERT(Helper::EqualsFileContent(PathHelper::GetDataDirectory() + "/writer/expected/short_number.xml", content));
     }
+
+    void test_write_decimal()
+    {
+		auto ws = wb_.create_sheet();
+        ws.get_cell("A1").set_value(3.14);
+        auto content = xlnt::writer::write_worksheet(ws, {}, {});
+        TS_ASSERT(Helper::EqualsFileContent(PathHelper::GetDataDirectory() + "/writer/expected/decimal.xml", content));
+    }
+    
+    void test_save_copies_unmodified_sheets()
+    {
+        auto path = PathHelper::GetDataDirectory("/genuine/empty.xlsx");
+        xlnt::workbook wb;
+        wb.load(path);
+        wb.get_sheet_by_name("Sheet2 - Numbers").get_cell("A1").set_value("new string");
+
+        std::vector<unsigned char> saved;
+        wb.save(saved);
+
+        xlnt::zip_file source(path);
+        xlnt::zip_file archive(saved);
+        TS_ASSERT_EQUALS(archive.read("xl/worksheets/sheet1.xml"), source.read("xl/worksheets/sheet1.xml"));
+        TS_ASSERT_EQUALS(archive.getinfo("xl/worksheets/sheet1.xml").compress_size, source.getinfo("xl/worksheets/sheet1.xml").compress_size);
+        TS_ASSERT_EQUALS(archive.read("xl/styles.xml"), source.read("xl/styles.xml"));
+        TS_ASSERT_DIFFERS(archive.read("xl/worksheets/sheet2.xml"), source.read("xl/worksheets/sheet2.xml"));
+
+        xlnt::workbook reloaded;
+        reloaded.load(saved);
+        TS_ASSERT_EQUALS(reloaded.get_sheet_by_name("Sheet1 - Text").get_cell("A1").get_value(), xlnt::value("This is cell A1 in Sheet 1"));
+        TS_ASSERT_EQUALS(reloaded.get_sheet_by_name("Sheet2 - Numbers").get_cell("A1").get_value(), xlnt::value("new string"));
+    }
     
     void _test_write_images()
     {
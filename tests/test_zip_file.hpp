@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <cxxtest/TestSuite.h>
@@ -208,6 +209,20 @@ public:
         TS_ASSERT(f.read(f.getinfo("[Content_Types].xml")) == expected_content_types_string);
     }
 
+    void test_read_stream()
+    {
+        xlnt::zip_file f(existing_file);
+
+        for(auto &name : f.namelist())
+        {
+            xlnt::zip_istream stream(f, name);
+            std::string streamed((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            TS_ASSERT(streamed == f.read(name));
+        }
+
+        TS_ASSERT_THROWS(xlnt::zip_istream(f, "missing.xml"), std::runtime_error);
+    }
+
     void test_testzip()
     {
         xlnt::zip_file f(existing_file);
@@ -260,6 +275,71 @@ public:
         remove_temp_file();
     }
 
+    void test_write_from()
+    {
+        xlnt::zip_file source(existing_file);
+        xlnt::zip_file f;
+        f.write_from(source, "xl/sharedStrings.xml");
+
+        std::vector<unsigned char> bytes;
+        f.save(bytes);
+
+        xlnt::zip_file f2(bytes);
+        TS_ASSERT_EQUALS(f2.namelist().size(), 1);
+        TS_ASSERT(f2.read("xl/sharedStrings.xml") == source.read("xl/sharedStrings.xml"));
+        TS_ASSERT_EQUALS(f2.getinfo("xl/sharedStrings.xml").compress_size, source.getinfo("xl/sharedStrings.xml").compress_size);
+    }
+
+    void test_zip64()
+    {
+        remove_temp_file();
+
+        // more than 4 GB of rows, which deflate to a few megabytes
+        const std::string row = "<row r=\"1\"><c r=\"A1\"><v>1</v></c></row>";
+        const std::uint64_t part_size = (std::uint64_t(1) << 32) + 1000 * row.size();
+
+        {
+            xlnt::zip_file f;
+            f.writestr("small.xml", "<small/>");
+
+            xlnt::zip_ostream stream(f, "large.xml", 1);
+            std::string chunk;
+
+            while(chunk.size() < (1 << 20))
+            {
+                chunk.append(row);
+            }
+
+            for(std::uint64_t written = 0; written < part_size; written += chunk.size())
+            {
+                stream.write(chunk.data(), (std::streamsize)std::min<std::uint64_t>(chunk.size(), part_size - written));
+            }
+
+            stream.close();
+            f.writestr("after.xml", "<after/>");
+            f.save(temp_file.GetFilename());
+        }
+
+        xlnt::zip_file f2(temp_file.GetFilename());
+        TS_ASSERT_EQUALS(f2.namelist().size(), 3);
+        TS_ASSERT_EQUALS(f2.getinfo("large.xml").file_size, part_size);
+        TS_ASSERT(f2.read("small.xml") == "<small/>");
+        TS_ASSERT(f2.read("after.xml") == "<after/>");
+
+        xlnt::zip_istream stream(f2, "large.xml");
+        std::vector<char> buffer(1 << 20);
+        std::uint64_t read = 0;
+
+        while(stream.read(buffer.data(), (std::streamsize)buffer.size()) || stream.gcount() > 0)
+        {
+            read += (std::uint64_t)stream.gcount();
+        }
+
+        TS_ASSERT_EQUALS(read, part_size);
+
+        remove_temp_file();
+    }
+
     void test_comment()
     {
         remove_temp_file();